@@ -26,6 +26,8 @@
 #include <sstream>
 #include <bitset>
 #include "numeric.h"
+#include "bitstream.h"
+#include <cmath>
 
 void Huffman::count_data_frequencies()
 {
@@ -291,148 +293,66 @@ void Huffman::walk_through_tree()
             throw std::runtime_error("Huffman doesn't have a single node, possibly internal bug");
         }
 
-        encoded_pairs.emplace(full_map.front().code, "1");
+        code_table[full_map.front().code] = { .bits = 1, .length = 1 };
         return;
     }
 
-    walk_to_next_node(0, *full_map.front().node, "");
+    walk_to_next_node(0, *full_map.front().node, 0);
 }
 
-void Huffman::walk_to_next_node(const uint64_t depth, const Node & node, const std::string & prefix)
+void Huffman::walk_to_next_node(const uint64_t depth, const Node & node, const uint32_t prefix)
 {
-    if (node.left == nullptr && node.right == nullptr) {
-        encoded_pairs.emplace(node.original_uint8_code, prefix);
+    if (node.left == nullptr && node.right == nullptr)
+    {
+        if (depth > 0xF /* Worst case for a 64 KB long data, and our utility is using 16 KB */) {
+            throw std::invalid_argument(R"(Bitstream too long, must be less than 16 bits (WTF data did you provide???))");
+        }
+
+        code_table[node.original_uint8_code] = { .bits = prefix, .length = static_cast<uint8_t>(depth) };
     }
 
     if (node.left != nullptr) {
-        walk_to_next_node(depth + 1, *node.left, prefix + "0");
+        walk_to_next_node(depth + 1, *node.left, prefix << 1);
     }
 
     if (node.right != nullptr) {
-        walk_to_next_node(depth + 1, *node.right, prefix + "1");
+        walk_to_next_node(depth + 1, *node.right, prefix << 1 | 1);
     }
 }
 
-void Huffman::encode_using_constructed_pairs()
-{
-    std::ranges::reverse(input_data_);
-    auto get = [&](uint8_t & c)->void {
-        c = input_data_.back();
-        input_data_.pop_back();
-    };
-
-    std::stringstream ss;
-    raw_dump.reserve(input_data_.size() * 8);
-    while (!input_data_.empty())
-    {
-        uint8_t c;
-        get(c);
-        ss << encoded_pairs.at(c);
-    }
-
-    raw_dump = ss.str();
-}
-
-std::vector<uint8_t> Huffman::convert_std_string_to_std_vector_from_raw_dump(uint64_t & bitSize) const
+std::vector<uint8_t> Huffman::encode_using_code_table(uint64_t & bitSize) const
 {
     std::vector<uint8_t> ret;
-    ret.reserve(raw_dump.size() / 8 + raw_dump.size() % 8);
-    for (int i = 0; i < raw_dump.size() / 8; i ++)
-    {
-        const std::string byte_stream = raw_dump.substr(i * 8, 8);
-        const uint8_t byte = std_string_to_uint8_t(byte_stream);
-        ret.push_back(byte);
-    }
-
-    if (raw_dump.size() % 8 != 0) {
-        const std::string byte_stream = raw_dump.substr(raw_dump.size() / 8 * 8);
-        const uint8_t byte = std_string_to_uint8_t(byte_stream);
-        ret.push_back(byte);
-    }
-
-    bitSize = raw_dump.size();
-    return ret;
-}
-
-uint8_t Huffman::std_string_to_uint8_t(const std::string & str)
-{
-    if (str.size() > 8) {
-        throw std::invalid_argument("String too long, must be less than or equal to 8");
-    }
-
-    uint8_t ret = 0;
-    const auto bit_offset = str.size() - 1;
-    for (size_t i = 0; i < str.size(); i++) {
-        ret |= (0x01 & (str[i] == '1' ? 0x01 : 0x00)) << (bit_offset - i);
-    }
-
-    return ret;
-}
-
-std::string Huffman::uint8_t_to_std_string(const uint8_t byte)
-{
-    std::string ret;
-
-    for (size_t i = 0; i < 8; i++) {
-        const uint8_t compliment = 0x01 << (7 - i);
-        const uint8_t bit_position = byte & compliment;
-        ret += bit_position == 0 ? "0" : "1";
+    ret.reserve(input_data_.size());
+    bit_writer writer(ret);
+    for (const auto byte : input_data_) {
+        writer.write(code_table[byte].bits, code_table[byte].length);
     }
 
+    bitSize = writer.flush(true);
     return ret;
 }
 
 std::vector<uint8_t> Huffman::export_table()
 {
     std::vector<uint8_t> ret;
-    std::unordered_map < uint8_t, uint8_t > table_entry_and_key_size;
-    std::string value_entry;
     bitwise_numeric_stack<4> byteStreamLength;
 
-    auto str_to_uint8 = [](const std::string & bitStream)->std::vector<uint8_t>
-    {
-        std::vector<uint8_t> ret_str_to_uint8;
-        for (int i = 0; i < bitStream.size() / 8; i ++)
-        {
-            const std::string byte_stream = bitStream.substr(i * 8, 8);
-            const uint8_t encoded_byte = std_string_to_uint8_t(byte_stream);
-            ret_str_to_uint8.push_back(encoded_byte);
-        }
-
-        if (bitStream.size() % 8 != 0) {
-            const std::string byte_stream = bitStream.substr(bitStream.size() / 8 * 8);
-            const uint8_t encoded_byte = std_string_to_uint8_t(byte_stream);
-            ret_str_to_uint8.push_back(encoded_byte);
-        }
-
-        return ret_str_to_uint8;
-    };
-
-    // dump table
-    for (const auto & [byte, bitStream] : encoded_pairs)
-    {
-        if (bitStream.size() > 0xF /* Worst case for a 64 KB long data, and our utility is using 16 KB */) {
-            throw std::invalid_argument(R"(Bitstream too long, must be less than 16 bits (WTF data did you provide???))");
-        }
-        const auto bitSize = static_cast<uint8_t>(bitStream.size());
-        table_entry_and_key_size.emplace(byte, bitSize);
-        value_entry += bitStream;
-    }
-
-    // dump key size
-    for (int i = 0; i < 256; i++) {
-        uint8_t bitSize = 0;
-        if (table_entry_and_key_size.contains(i)) {
-            bitSize = table_entry_and_key_size.at(i);
-        }
-        byteStreamLength.emplace(bitSize);
+    // dump key size, codes are no longer than 15 bits
+    for (const auto & [bits, length] : code_table) {
+        byteStreamLength.emplace(length);
     }
 
     // dump key size to vectorized data
     const auto byteStreamLengthVec = byteStreamLength.dump();
 
-    // code byte stream
-    const auto val_vec_entry = str_to_uint8(value_entry);
+    // code byte stream, codes back to back in byte order
+    std::vector<uint8_t> val_vec_entry;
+    bit_writer writer(val_vec_entry);
+    for (const auto & [bits, length] : code_table) {
+        writer.write(bits, length);
+    }
+    writer.flush(true);
 
     // [ (256 * 4 / 8 = 128 Bytes) ] [ Encoding Byte Stream ]
     // 1. push each byte stream encoding length (16 bits max)
@@ -442,28 +362,15 @@ std::vector<uint8_t> Huffman::export_table()
     return ret;
 }
 
-void Huffman::import_table(const std::vector<uint8_t> & table_)
+void Huffman::left_align_tail(std::vector<uint8_t> & data, const uint64_t bits)
 {
-    std::streamsize get_off = 0;
-    auto uint8_to_str = [](const std::vector<uint8_t> & byteStream, const uint64_t bits)->std::string
-    {
-        std::string ret_uint8_to_str;
-        for (int i = 0; i < bits / 8; i ++)
-        {
-            const std::string byte_stream = uint8_t_to_std_string(byteStream[i]);
-            ret_uint8_to_str += byte_stream;
-        }
-
-        if (bits % 8 != 0) {
-            const uint64_t tailing_bits = bits % 8;
-            std::string byte_stream = uint8_t_to_std_string(byteStream.back());
-            byte_stream = byte_stream.substr(byte_stream.size() - tailing_bits, tailing_bits);
-            ret_uint8_to_str += byte_stream;
-        }
-
-        return ret_uint8_to_str;
-    };
+    if (bits % 8 != 0 && bits / 8 < data.size()) {
+        data[bits / 8] = static_cast<uint8_t>(data[bits / 8] << (8 - bits % 8));
+    }
+}
 
+void Huffman::import_table(const std::vector<uint8_t> & table_)
+{
     // 1. import bit string length
     std::vector<uint8_t> length_data;
     bitwise_numeric_stack<4> byteStreamLength;
@@ -471,85 +378,66 @@ void Huffman::import_table(const std::vector<uint8_t> & table_)
     length_data.insert(end(length_data),
         begin(table_), begin(table_) + bytes_in_byte_stream);
     byteStreamLength.import(length_data, 256);
-    get_off += bytes_in_byte_stream;
 
     // 2. copy encoding table
     // 2.1 copy raw data
     std::vector<uint8_t> table_vals;
-    table_vals.insert(end(table_vals), begin(table_) + get_off, end(table_));
+    table_vals.insert(end(table_vals), begin(table_) + bytes_in_byte_stream, end(table_));
     // 2.2 get accumulated bit size
     uint64_t bits_total = 0;
-    for (uint64_t i = 0; i < byteStreamLength.size(); i++) {
-        bits_total += byteStreamLength[i].export_numeric<uint64_t>();
-    }
-
-    // recover bit stream
-    const std::string bitStream = uint8_to_str(table_vals, bits_total);
-
-    // assign bit stream
-    uint64_t bit_stream_offset = 0;
-    for (int i = 0; i < 256; i++)
+    for (uint64_t i = 0; i < byteStreamLength.size(); i++)
     {
-        const auto & byte = byteStreamLength[i];
-        const auto current_bit_size = byte.export_numeric<uint8_t>();
-        if (current_bit_size != 0)
-        {
-            encoded_pairs[i] = bitStream.substr(bit_stream_offset, current_bit_size);
-            bit_stream_offset += current_bit_size;
-        }
+        code_table[i].length = byteStreamLength[i].export_numeric<uint8_t>();
+        bits_total += code_table[i].length;
     }
-}
 
-void Huffman::convert_input_to_raw_dump(const uint64_t bits)
-{
-    raw_dump.reserve(bits);
-    for (int i = 0; i < bits / 8; i++)
-    {
-        const std::string bit_stream = uint8_t_to_std_string(input_data_[i]);
-        raw_dump.append(bit_stream);
-    }
-
-    if (bits % 8 != 0) {
-        const uint64_t tailing_bits = bits % 8;
-        const uint8_t tailing_byte = input_data_[bits / 8];
-        std::string bit_stream = uint8_t_to_std_string(tailing_byte);
-        bit_stream = bit_stream.substr(bit_stream.size() - tailing_bits, tailing_bits);
-        raw_dump.append(bit_stream);
+    // read codes back in byte order
+    left_align_tail(table_vals, bits_total);
+    bit_reader reader(table_vals);
+    for (auto & [bits, length] : code_table) {
+        bits = static_cast<uint32_t>(reader.read(length));
     }
 }
 
-void Huffman::decode_using_constructed_pairs()
+void Huffman::build_decode_table()
 {
-    uint64_t offset = 0;
-    uint64_t current_bit_size = 1;
-
-    std::map < std::string, uint8_t > flipped_pairs;
-    for (const auto & [byte, bitStream] : encoded_pairs) {
-        flipped_pairs.emplace(bitStream, byte);
+    decode_table_bits = 0;
+    for (const auto & [bits, length] : code_table) {
+        decode_table_bits = std::max<uint64_t>(decode_table_bits, length);
     }
 
-    auto can_find_reference = [&](const uint64_t bit_offset, const uint64_t bit_size, uint8_t & decoded)->bool
+    // every index starting with a code maps to it, whatever the bits after it are
+    decode_table.assign(1ull << decode_table_bits, { });
+    for (uint64_t symbol = 0; symbol < code_table.size(); symbol++)
     {
-        const std::string current_reference = raw_dump.substr(bit_offset, bit_size);
-        const auto reference = flipped_pairs.find(current_reference);
-        if (reference == flipped_pairs.end()) {
-            return false;
+        const auto & [bits, length] = code_table[symbol];
+        if (length == 0) {
+            continue;
         }
 
-        decoded = (reference->second);
-        return true;
-    };
+        const uint64_t first = static_cast<uint64_t>(bits) << (decode_table_bits - length);
+        const uint64_t last = first + (1ull << (decode_table_bits - length));
+        for (uint64_t index = first; index < last; index++) {
+            decode_table[index] = { .symbol = static_cast<uint8_t>(symbol), .length = length };
+        }
+    }
+}
 
-    while (offset < raw_dump.size())
+void Huffman::decode_using_decode_table(const uint64_t bits)
+{
+    left_align_tail(input_data_, bits);
+    bit_reader reader(input_data_);
+    uint64_t offset = 0;
+    while (offset < bits)
     {
-        uint8_t decoded = 0;
-        while (!can_find_reference(offset, current_bit_size, decoded)) {
-            current_bit_size++;
+        const auto & [symbol, length] = decode_table[reader.peek(decode_table_bits)];
+        if (length == 0 || offset + length > bits) {
+            throw std::runtime_error("Huffman bitstream corrupted");
         }
 
-        output_data_.push_back(decoded);
-        offset += current_bit_size;
-        current_bit_size = 1;
+        reader.skip(length);
+        offset += length;
+        output_data_.push_back(symbol);
     }
 }
 
@@ -559,8 +447,7 @@ void Huffman::compress()
     count_data_frequencies();
     build_binary_tree_based_on_the_frequency_map();
     walk_through_tree();
-    encode_using_constructed_pairs();
-    auto data = convert_std_string_to_std_vector_from_raw_dump(bits);
+    const auto data = encode_using_code_table(bits);
     const auto table = export_table();
     const auto table_size = static_cast<uint16_t>(table.size());
 
@@ -594,6 +481,448 @@ void Huffman::decompress()
     read_offset += 3;
 
     input_data_.erase(begin(input_data_), begin(input_data_) + static_cast<int64_t>(read_offset));
-    convert_input_to_raw_dump(bits);
-    decode_using_constructed_pairs();
+    build_decode_table();
+    decode_using_decode_table(bits);
+}
+
+void Huffman::build_length_limited_code_lengths(const std::array < uint64_t, 256 > & frequencies)
+{
+    // package-merge, leaves in increasing frequency
+    std::vector < std::pair < uint8_t, uint64_t > > leaves;
+    for (uint64_t symbol = 0; symbol < frequencies.size(); symbol++)
+    {
+        if (frequencies[symbol] != 0) {
+            leaves.emplace_back(static_cast<uint8_t>(symbol), frequencies[symbol]);
+        }
+    }
+
+    std::ranges::stable_sort(leaves, [](const auto & left, const auto & right)->bool {
+        return left.second < right.second;
+    });
+
+    code_table = { };
+    if (leaves.size() == 1)
+    {
+        code_table[leaves.front().first].length = 1;
+        return;
+    }
+
+    // a package holds items package and package + 1 of the list one level deeper
+    struct item {
+        uint64_t weight = 0;
+        int64_t leaf = -1;
+        uint64_t package = 0;
+    };
+
+    // only the first 2n - 2 items of a list can ever be picked
+    const uint64_t needed = leaves.size() * 2 - 2;
+    std::vector < std::vector < item > > lists(canonical_max_length);
+    for (uint64_t level = 0; level < canonical_max_length; level++)
+    {
+        auto & list = lists[level];
+        const uint64_t packages = level == 0 ? 0 : lists[level - 1].size() / 2;
+        uint64_t leaf = 0, package = 0;
+        while (list.size() < needed && (leaf < leaves.size() || package < packages))
+        {
+            const uint64_t package_weight = package < packages
+                ? lists[level - 1][package * 2].weight + lists[level - 1][package * 2 + 1].weight : 0;
+            if (package == packages || (leaf < leaves.size() && leaves[leaf].second <= package_weight))
+            {
+                list.push_back({ .weight = leaves[leaf].second, .leaf = static_cast<int64_t>(leaf) });
+                leaf++;
+            }
+            else
+            {
+                list.push_back({ .weight = package_weight, .package = package * 2 });
+                package++;
+            }
+        }
+    }
+
+    // a symbol is as long as the number of times its leaf is picked
+    std::vector < std::pair < uint64_t /* level */, uint64_t /* index */ > > pending;
+    for (uint64_t index = 0; index < needed; index++) {
+        pending.emplace_back(canonical_max_length - 1, index);
+    }
+
+    while (!pending.empty())
+    {
+        const auto [level, index] = pending.back();
+        pending.pop_back();
+        if (const auto & picked = lists[level][index]; picked.leaf >= 0) {
+            code_table[leaves[picked.leaf].first].length++;
+        } else {
+            pending.emplace_back(level - 1, picked.package);
+            pending.emplace_back(level - 1, picked.package + 1);
+        }
+    }
+}
+
+void Huffman::assign_canonical_codes()
+{
+    // shorter codes first, and in symbol order within one length
+    std::array < uint64_t, canonical_max_length + 1 > length_count { };
+    for (const auto & [bits, length] : code_table)
+    {
+        if (length > canonical_max_length) {
+            throw std::runtime_error("Huffman code length out of range");
+        }
+
+        length_count[length]++;
+    }
+
+    length_count[0] = 0;
+    std::array < uint64_t, canonical_max_length + 1 > next_code { };
+    uint64_t code = 0;
+    for (uint64_t length = 1; length <= canonical_max_length; length++)
+    {
+        code = (code + length_count[length - 1]) << 1;
+        next_code[length] = code;
+    }
+
+    for (auto & [bits, length] : code_table)
+    {
+        if (length == 0) {
+            continue;
+        }
+
+        if (next_code[length] >> length != 0) {
+            throw std::runtime_error("Huffman code lengths oversubscribed");
+        }
+
+        bits = static_cast<uint32_t>(next_code[length]++);
+    }
+}
+
+uint8_t Huffman::decode_symbol(bit_reader & reader) const
+{
+    const auto & [symbol, length] = decode_table[reader.peek(decode_table_bits)];
+    if (length == 0) {
+        throw std::runtime_error("Huffman bitstream corrupted");
+    }
+
+    reader.skip(length);
+    return symbol;
+}
+
+std::array < uint64_t, 256 > Huffman::count_symbol_frequencies() const
+{
+    std::array < uint64_t, 256 > frequencies { };
+    for (const auto byte : input_data_) {
+        frequencies[byte]++;
+    }
+
+    return frequencies;
+}
+
+uint64_t Huffman::canonical_table_size(const std::array < uint64_t, 256 > & frequencies)
+{
+    uint64_t first_symbol = 0, last_symbol = 255;
+    while (first_symbol < last_symbol && frequencies[first_symbol] == 0) {
+        first_symbol++;
+    }
+
+    while (last_symbol > first_symbol && frequencies[last_symbol] == 0) {
+        last_symbol--;
+    }
+
+    return 2 + (last_symbol - first_symbol + 2) / 2;
+}
+
+void Huffman::export_canonical_table()
+{
+    uint64_t first_symbol = 0, last_symbol = 255;
+    while (code_table[first_symbol].length == 0) {
+        first_symbol++;
+    }
+
+    while (code_table[last_symbol].length == 0) {
+        last_symbol--;
+    }
+
+    bitwise_numeric_stack<4> lengths;
+    for (uint64_t symbol = first_symbol; symbol <= last_symbol; symbol++) {
+        lengths.emplace(code_table[symbol].length);
+    }
+
+    // [First Symbol] [Last Symbol] [4bit Code Lengths from First to Last]
+    const auto lengths_data = lengths.dump();
+    output_data_.push_back(static_cast<uint8_t>(first_symbol));
+    output_data_.push_back(static_cast<uint8_t>(last_symbol));
+    output_data_.insert(end(output_data_), begin(lengths_data), end(lengths_data));
+}
+
+void Huffman::import_canonical_table(uint64_t & read_offset)
+{
+    if (input_data_.size() < 2 || input_data_[1] < input_data_[0]) {
+        throw std::runtime_error("Huffman table corrupted");
+    }
+
+    const uint64_t first_symbol = input_data_[0];
+    const uint64_t symbols = input_data_[1] - first_symbol + 1;
+    const uint64_t lengths_size = (symbols + 1) / 2;
+    read_offset = 2;
+    if (input_data_.size() < read_offset + lengths_size) {
+        throw std::runtime_error("Huffman table truncated");
+    }
+
+    const std::vector<uint8_t> lengths_data(begin(input_data_) + static_cast<int64_t>(read_offset),
+        begin(input_data_) + static_cast<int64_t>(read_offset + lengths_size));
+    bitwise_numeric_stack<4> lengths;
+    lengths.import(lengths_data, symbols);
+    read_offset += lengths_size;
+
+    code_table = { };
+    for (uint64_t i = 0; i < symbols; i++) {
+        code_table[first_symbol + i].length = lengths[i].export_numeric<uint8_t>();
+    }
+
+    assign_canonical_codes();
+    build_decode_table();
+}
+
+void Huffman::save_solid_table() const
+{
+    if (solid_table_ == nullptr) {
+        return;
+    }
+
+    for (uint64_t symbol = 0; symbol < code_table.size(); symbol++) {
+        solid_table_->lengths[symbol] = code_table[symbol].length;
+    }
+
+    solid_table_->valid = true;
+}
+
+void Huffman::load_solid_table()
+{
+    if (solid_table_ == nullptr || !solid_table_->valid) {
+        throw std::runtime_error("Huffman block repeats a table that was never sent");
+    }
+
+    code_table = { };
+    for (uint64_t symbol = 0; symbol < code_table.size(); symbol++) {
+        code_table[symbol].length = solid_table_->lengths[symbol];
+    }
+
+    assign_canonical_codes();
+}
+
+void Huffman::encode_streams(const uint64_t streams)
+{
+    // [16bit Symbol Count] ([16bit Size of Streams 1 to 3]) [Stream 1] ([Stream 2] [Stream 3] [Stream 4]),
+    // stream i holds the codes of the i-th part of the input
+    const auto symbol_count = static_cast<uint16_t>(input_data_.size());
+    output_data_.push_back(reinterpret_cast<const uint8_t*>(&symbol_count)[0]);
+    output_data_.push_back(reinterpret_cast<const uint8_t*>(&symbol_count)[1]);
+
+    if (streams == 1)
+    {
+        bit_writer writer(output_data_);
+        for (const auto byte : input_data_) {
+            writer.write(code_table[byte].bits, code_table[byte].length);
+        }
+
+        writer.flush();
+        return;
+    }
+
+    const uint64_t segment_size = (input_data_.size() + interleaved_streams - 1) / interleaved_streams;
+    std::array < std::vector < uint8_t >, interleaved_streams > interleaved;
+    for (uint64_t stream = 0; stream < interleaved_streams; stream++)
+    {
+        bit_writer writer(interleaved[stream]);
+        const uint64_t first = std::min<uint64_t>(stream * segment_size, input_data_.size());
+        const uint64_t last = std::min<uint64_t>(first + segment_size, input_data_.size());
+        for (uint64_t i = first; i < last; i++) {
+            writer.write(code_table[input_data_[i]].bits, code_table[input_data_[i]].length);
+        }
+
+        writer.flush();
+    }
+
+    for (uint64_t stream = 0; stream + 1 < interleaved_streams; stream++)
+    {
+        const auto stream_size = static_cast<uint16_t>(interleaved[stream].size());
+        output_data_.push_back(reinterpret_cast<const uint8_t*>(&stream_size)[0]);
+        output_data_.push_back(reinterpret_cast<const uint8_t*>(&stream_size)[1]);
+    }
+
+    for (const auto & stream : interleaved) {
+        output_data_.insert(end(output_data_), begin(stream), end(stream));
+    }
+}
+
+void Huffman::decode_streams(const uint64_t streams, uint64_t read_offset)
+{
+    if (input_data_.size() < read_offset + sizeof(uint16_t)) {
+        throw std::runtime_error("Huffman symbol count truncated");
+    }
+
+    uint16_t symbol_count = 0;
+    std::memcpy(&symbol_count, input_data_.data() + read_offset, sizeof(uint16_t));
+    read_offset += sizeof(uint16_t);
+
+    if (streams == 1)
+    {
+        input_data_.erase(begin(input_data_), begin(input_data_) + static_cast<int64_t>(read_offset));
+        bit_reader reader(input_data_);
+        output_data_.reserve(output_data_.size() + symbol_count);
+        for (uint64_t i = 0; i < symbol_count; i++) {
+            output_data_.push_back(decode_symbol(reader));
+        }
+
+        return;
+    }
+
+    std::array < uint64_t, interleaved_streams + 1 > stream_offsets { };
+    if (input_data_.size() < read_offset + (interleaved_streams - 1) * sizeof(uint16_t)) {
+        throw std::runtime_error("Huffman stream sizes truncated");
+    }
+
+    stream_offsets[0] = read_offset + (interleaved_streams - 1) * sizeof(uint16_t);
+    for (uint64_t stream = 0; stream + 1 < interleaved_streams; stream++)
+    {
+        uint16_t stream_size = 0;
+        std::memcpy(&stream_size, input_data_.data() + read_offset + stream * sizeof(uint16_t), sizeof(uint16_t));
+        stream_offsets[stream + 1] = stream_offsets[stream] + stream_size;
+    }
+
+    stream_offsets[interleaved_streams] = input_data_.size();
+    if (stream_offsets[interleaved_streams - 1] > input_data_.size()) {
+        throw std::runtime_error("Huffman stream sizes corrupted");
+    }
+
+    std::array < std::vector < uint8_t >, interleaved_streams > interleaved;
+    std::vector < bit_reader > readers;
+    for (uint64_t stream = 0; stream < interleaved_streams; stream++)
+    {
+        interleaved[stream].assign(begin(input_data_) + static_cast<int64_t>(stream_offsets[stream]),
+            begin(input_data_) + static_cast<int64_t>(stream_offsets[stream + 1]));
+        readers.emplace_back(interleaved[stream]);
+    }
+
+    // the four chains do not depend on each other, so they overlap in one loop
+    const uint64_t segment_size = (symbol_count + interleaved_streams - 1) / interleaved_streams;
+    const uint64_t last_segment_size = symbol_count - std::min<uint64_t>(symbol_count, segment_size * (interleaved_streams - 1));
+    const uint64_t output_offset = output_data_.size();
+    output_data_.resize(output_offset + symbol_count);
+    uint8_t * out = output_data_.data() + output_offset;
+    for (uint64_t i = 0; i < last_segment_size; i++)
+    {
+        out[i] = decode_symbol(readers[0]);
+        out[segment_size + i] = decode_symbol(readers[1]);
+        out[segment_size * 2 + i] = decode_symbol(readers[2]);
+        out[segment_size * 3 + i] = decode_symbol(readers[3]);
+    }
+
+    for (uint64_t stream = 0; stream + 1 < interleaved_streams; stream++)
+    {
+        const uint64_t first = stream * segment_size;
+        const uint64_t last = std::min<uint64_t>(first + segment_size, symbol_count);
+        for (uint64_t i = first + last_segment_size; i < last; i++) {
+            out[i] = decode_symbol(readers[stream]);
+        }
+    }
+}
+
+void Huffman::compress_canonical()
+{
+    build_length_limited_code_lengths(count_symbol_frequencies());
+    assign_canonical_codes();
+    save_solid_table();
+
+    // [Table] [Codes]
+    export_canonical_table();
+    encode_streams(1);
+}
+
+void Huffman::decompress_canonical()
+{
+    uint64_t read_offset = 0;
+    import_canonical_table(read_offset);
+    save_solid_table();
+    decode_streams(1, read_offset);
+}
+
+void Huffman::compress_interleaved()
+{
+    build_length_limited_code_lengths(count_symbol_frequencies());
+    assign_canonical_codes();
+    save_solid_table();
+
+    // [Table] [Streams]
+    export_canonical_table();
+    encode_streams(interleaved_streams);
+}
+
+void Huffman::decompress_interleaved()
+{
+    uint64_t read_offset = 0;
+    import_canonical_table(read_offset);
+    save_solid_table();
+    decode_streams(interleaved_streams, read_offset);
+}
+
+bool Huffman::compress_solid(const bool interleaved)
+{
+    if (solid_table_ == nullptr) {
+        throw std::invalid_argument("Huffman has no solid table to reuse");
+    }
+
+    const auto frequencies = count_symbol_frequencies();
+    const uint64_t streams = interleaved ? interleaved_streams : 1;
+
+    // what the previous table spends, ruled out if it has no code for a symbol of this block
+    bool repeatable = solid_table_->valid;
+    uint64_t repeat_bits = 0;
+    long double entropy_bits = 0;
+    for (uint64_t symbol = 0; symbol < frequencies.size(); symbol++)
+    {
+        if (frequencies[symbol] == 0) {
+            continue;
+        }
+
+        repeatable = repeatable && solid_table_->lengths[symbol] != 0;
+        repeat_bits += frequencies[symbol] * solid_table_->lengths[symbol];
+        entropy_bits -= static_cast<long double>(frequencies[symbol])
+            * std::log2(static_cast<long double>(frequencies[symbol]) / static_cast<long double>(input_data_.size()));
+    }
+
+    const uint64_t table_size = canonical_table_size(frequencies);
+    const uint64_t repeat_size = (repeat_bits + 7) / 8;
+    auto close_enough = [&](const uint64_t fresh_size)->bool {
+        return repeatable && repeat_size <= fresh_size + fresh_size / repeat_table_tolerance;
+    };
+
+    // no new table beats the entropy, so a previous one close enough to it is kept without building a tree
+    if (!close_enough(static_cast<uint64_t>(entropy_bits / 8) + table_size))
+    {
+        build_length_limited_code_lengths(frequencies);
+        uint64_t fresh_bits = 0;
+        for (uint64_t symbol = 0; symbol < frequencies.size(); symbol++) {
+            fresh_bits += frequencies[symbol] * code_table[symbol].length;
+        }
+
+        if (!close_enough((fresh_bits + 7) / 8 + table_size))
+        {
+            assign_canonical_codes();
+            save_solid_table();
+            export_canonical_table();
+            encode_streams(streams);
+            return false;
+        }
+    }
+
+    // [Codes], the table is the one already sent
+    load_solid_table();
+    encode_streams(streams);
+    return true;
+}
+
+void Huffman::decompress_repeat(const bool interleaved)
+{
+    load_solid_table();
+    build_decode_table();
+    decode_streams(interleaved ? interleaved_streams : 1, 0);
 }
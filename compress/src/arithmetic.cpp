@@ -19,7 +19,12 @@
  */
 
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <functional>
+#include <stdexcept>
 #include "arithmetic.h"
+#include "rans.h"
 #include <cstdio>
 #include <cstdint>
 
@@ -36,25 +41,71 @@ Compress::Compress()
     for ( i = 0; i <= NO_OF_SYMBOLS; i++)
     {
         freq[i] = 1;
-        cum_freq[i] = NO_OF_SYMBOLS - i;
     }
     freq[0] = 0;
+    build_tree();
 }
 
-void Compress::update_tables(const int sym_index)
+void Compress::build_tree()
 {
-    int i;
-    if (cum_freq[0] == MAX_FREQ)
+    constexpr int size = NO_OF_SYMBOLS + 1;
+    for (int i = 1; i <= size; i++) {
+        tree[i] = freq[i - 1];
+    }
+
+    for (int i = 1; i <= size; i++)
+    {
+        if (const int parent = i + (i & -i); parent <= size) {
+            tree[parent] += tree[i];
+        }
+    }
+}
+
+int Compress::prefix(const int index) const
+{
+    int sum = 0;
+    for (int i = index + 1; i > 0; i -= i & -i) {
+        sum += tree[i];
+    }
+
+    return sum;
+}
+
+int Compress::cum_freq(const int index) const
+{
+    return prefix(NO_OF_SYMBOLS) - prefix(index);
+}
+
+int Compress::find_symbol(const int cum) const
+{
+    // smallest index with prefix(index) >= total - cum, found by walking down the tree
+    constexpr int size = NO_OF_SYMBOLS + 1;
+    int target = total() - cum;
+    int position = 0;
+    for (int step = std::bit_floor(static_cast<unsigned>(size)); step > 0; step >>= 1)
     {
-        int cum = 0;
-        for ( i = NO_OF_SYMBOLS; i >= 0; i--)
+        if (position + step <= size && tree[position + step] < target)
         {
+            position += step;
+            target -= tree[position];
+        }
+    }
+
+    return std::clamp(position, 1, NO_OF_SYMBOLS);
+}
+
+void Compress::update_tables(const int sym_index)
+{
+    if (total() == MAX_FREQ)
+    {
+        for (int i = NO_OF_SYMBOLS; i >= 0; i--) {
             freq[i] = (freq[i] + 1) / 2;
-            cum_freq[i] = cum;
-            cum += freq[i];
         }
+        build_tree();
     }
-    for ( i = sym_index; freq[i] == freq[i - 1]; i--) {}
+
+    // freq is non-increasing from index 1 on, so the first index of the run sym_index is in is a binary search away
+    const int i = static_cast<int>(std::lower_bound(freq + 1, freq + sym_index, freq[sym_index], std::greater<>()) - freq);
     if (i < sym_index)
     {
         const int ch_i = index_to_char[i];
@@ -65,10 +116,8 @@ void Compress::update_tables(const int sym_index)
         char_to_index[ch_symbol] = i;
     }
     freq[i]++;
-    while (i > 0)
-    {
-        i--;
-        cum_freq[i]++;
+    for (int j = i + 1; j <= NO_OF_SYMBOLS + 1; j += j & -j) {
+        tree[j]++;
     }
 }
 
@@ -108,8 +157,9 @@ void Encode::encode()
 void Encode::encode_symbol(const int symbol)
 {
     const int range = high - low;
-    high = low + (range * cum_freq [symbol - 1]) / cum_freq [0];
-    low = low + (range * cum_freq [symbol]) / cum_freq [0];
+    const int total_freq = total();
+    high = low + (range * cum_freq(symbol - 1)) / total_freq;
+    low = low + (range * cum_freq(symbol)) / total_freq;
     for (;;)
     {
         if (high < HALF)
@@ -208,10 +258,11 @@ int Decode::decode_symbol()
     int symbol_index;
 
     const int range = high - low;
-    const int cum = ((((value - low) + 1) * cum_freq[0] - 1) / range);
-    for (symbol_index = 1; cum_freq[symbol_index] > cum; symbol_index++) {}
-    high = low + (range * cum_freq[symbol_index - 1]) / cum_freq[0];
-    low = low + (range * cum_freq[symbol_index]) / cum_freq[0];
+    const int total_freq = total();
+    const int cum = ((((value - low) + 1) * total_freq - 1) / range);
+    symbol_index = find_symbol(cum);
+    high = low + (range * cum_freq(symbol_index - 1)) / total_freq;
+    low = low + (range * cum_freq(symbol_index)) / total_freq;
     for (;;)
     {
         if (high < HALF)
@@ -256,3 +307,335 @@ int Decode::get_bit()
     bits_in_buf--;
     return t;
 }
+
+void range_encoder::encode(const uint32_t start, const uint32_t size, const uint32_t total)
+{
+    range /= total; // range is at least 2^24, so precision stays above 8 bits
+    low += static_cast<uint64_t>(start) * range;
+    range *= size;
+
+    while (range < RANGE_TOP)
+    {
+        range <<= 8;
+        shift_low();
+    }
+}
+
+void range_encoder::encode_scaled(const uint32_t start, const uint32_t size, const uint32_t total_bits)
+{
+    range >>= total_bits;
+    low += static_cast<uint64_t>(start) * range;
+    range *= size;
+
+    while (range < RANGE_TOP)
+    {
+        range <<= 8;
+        shift_low();
+    }
+}
+
+void range_encoder::encode_bit(uint16_t & probability, const int bit)
+{
+    const uint32_t bound = (range >> BIT_PROBABILITY_BITS) * probability;
+    if (bit == 0)
+    {
+        range = bound;
+        probability += ((1u << BIT_PROBABILITY_BITS) - probability) >> BIT_ADAPT_SHIFT;
+    }
+    else
+    {
+        low += bound;
+        range -= bound;
+        probability -= probability >> BIT_ADAPT_SHIFT;
+    }
+
+    while (range < RANGE_TOP)
+    {
+        range <<= 8;
+        shift_low();
+    }
+}
+
+void range_encoder::shift_low()
+{
+    // the top byte can still change by a carry if it is 0xFF, hold it back until that is known
+    if (static_cast<uint32_t>(low) < 0xFF000000 || (low >> 32) != 0)
+    {
+        const auto carry = static_cast<uint8_t>(low >> 32);
+        uint8_t byte = cache;
+        do
+        {
+            if (!first_byte) {
+                out.push_back(static_cast<uint8_t>(byte + carry));
+            }
+            first_byte = false;
+            byte = 0xFF;
+        } while (--pending_bytes != 0);
+        cache = static_cast<uint8_t>(low >> 24);
+    }
+
+    pending_bytes++;
+    low = (low & 0x00FFFFFF) << 8;
+}
+
+void range_encoder::flush()
+{
+    // end on the value in [low, low + range) with the most trailing zero bits,
+    // the decoder reads zeros past the end so a few of these are left out
+    for (int bits = 32; bits > 0; bits--)
+    {
+        const uint64_t mask = (1ull << bits) - 1;
+        if (const uint64_t value = (low + mask) & ~mask; value < low + range) {
+            low = value;
+            break;
+        }
+    }
+
+    for (int i = 0; i < 5; i++) {
+        shift_low();
+    }
+
+    for (uint64_t i = 0; i < RANGE_TRAILING_ZEROS_MAX && out.size() > out_begin && out.back() == 0; i++) {
+        out.pop_back();
+    }
+}
+
+range_decoder::range_decoder(const std::vector<uint8_t> & in_) : in(in_)
+{
+    for (int i = 0; i < 4; i++) {
+        code = code << 8 | get();
+    }
+}
+
+uint32_t range_decoder::target(const uint32_t total)
+{
+    range /= total;
+    const uint32_t cum = code / range;
+    if (cum >= total) {
+        throw std::runtime_error("Corrupted range coded stream");
+    }
+
+    return cum;
+}
+
+uint32_t range_decoder::target_scaled(const uint32_t total_bits)
+{
+    range >>= total_bits;
+    const uint32_t cum = code / range;
+    if (cum >> total_bits) {
+        throw std::runtime_error("Corrupted range coded stream");
+    }
+
+    return cum;
+}
+
+int range_decoder::decode_bit(uint16_t & probability)
+{
+    const uint32_t bound = (range >> BIT_PROBABILITY_BITS) * probability;
+    int bit;
+    if (code < bound)
+    {
+        range = bound;
+        probability += ((1u << BIT_PROBABILITY_BITS) - probability) >> BIT_ADAPT_SHIFT;
+        bit = 0;
+    }
+    else
+    {
+        code -= bound;
+        range -= bound;
+        probability -= probability >> BIT_ADAPT_SHIFT;
+        bit = 1;
+    }
+
+    while (range < RANGE_TOP)
+    {
+        code = code << 8 | get();
+        range <<= 8;
+    }
+
+    return bit;
+}
+
+void range_decoder::decode(const uint32_t start, const uint32_t size)
+{
+    code -= start * range;
+    range *= size;
+
+    while (range < RANGE_TOP)
+    {
+        code = code << 8 | get();
+        range <<= 8;
+    }
+}
+
+void RangeEncode::encode()
+{
+    if (in.empty()) {
+        return;
+    }
+
+    for (const auto ch : in)
+    {
+        const int symbol = char_to_index[ch];
+        encode_symbol(symbol);
+        update_tables(symbol);
+    }
+    encode_symbol(EOF_SYMBOL);
+    encoder.flush();
+}
+
+void RangeEncode::encode_symbol(const int symbol)
+{
+    const auto start = static_cast<uint32_t>(cum_freq(symbol));
+    const auto size = static_cast<uint32_t>(cum_freq(symbol - 1)) - start;
+    encoder.encode(start, size, static_cast<uint32_t>(total()));
+}
+
+void RangeDecode::decode()
+{
+    if (in.empty()) {
+        return;
+    }
+
+    const auto out_begin = out.size();
+    range_decoder decoder(in);
+    while (true)
+    {
+        const int sym_index = decode_symbol(decoder);
+        if (sym_index == EOF_SYMBOL) {
+            break;
+        }
+        // no block is longer than this, a stream that keeps going past it is corrupted
+        if (out.size() - out_begin == UINT16_MAX) {
+            throw std::runtime_error("Corrupted range coded stream");
+        }
+        out.push_back(index_to_char[sym_index]);
+        update_tables(sym_index);
+    }
+}
+
+int RangeDecode::decode_symbol(range_decoder & decoder)
+{
+    const int symbol_index = find_symbol(static_cast<int>(decoder.target(static_cast<uint32_t>(total()))));
+    const auto start = static_cast<uint32_t>(cum_freq(symbol_index));
+    const auto size = static_cast<uint32_t>(cum_freq(symbol_index - 1)) - start;
+    decoder.decode(start, size);
+    return symbol_index;
+}
+
+// [16bit length][frequency table][range coded data]
+void StaticEncode::encode()
+{
+    if (in.empty()) {
+        return;
+    }
+
+    rans::frequency_table counts{};
+    for (const auto ch : in) {
+        counts[ch]++;
+    }
+
+    const auto freqs = rans::normalize(counts, in.size());
+    rans::frequency_table starts{};
+    for (int i = 1; i < NO_OF_CHARS; i++) {
+        starts[i] = starts[i - 1] + freqs[i - 1];
+    }
+
+    const auto length = static_cast<uint16_t>(in.size());
+    out.push_back(static_cast<uint8_t>(length & 0xFF));
+    out.push_back(static_cast<uint8_t>(length >> 8));
+    rans::write_frequencies(freqs, out);
+
+    range_encoder encoder(out);
+    for (const auto ch : in) {
+        encoder.encode_scaled(starts[ch], freqs[ch], rans::scale_bits);
+    }
+    encoder.flush();
+}
+
+void StaticDecode::decode()
+{
+    if (in.empty()) {
+        return;
+    }
+
+    if (in.size() < 2) {
+        throw std::runtime_error("Corrupted range coded stream");
+    }
+
+    const uint16_t length = in[0] | static_cast<uint16_t>(in[1] << 8);
+    uint64_t position = 2;
+    const auto freqs = rans::read_frequencies(in, position);
+
+    rans::frequency_table starts{};
+    std::vector<uint8_t> slots(rans::scale);
+    for (uint32_t i = 0, start = 0; i < NO_OF_CHARS; i++)
+    {
+        starts[i] = start;
+        std::fill_n(slots.begin() + start, freqs[i], static_cast<uint8_t>(i));
+        start += freqs[i];
+    }
+
+    const std::vector<uint8_t> data(in.begin() + static_cast<std::ptrdiff_t>(position), in.end());
+    range_decoder decoder(data);
+    out.reserve(out.size() + length);
+    for (uint32_t i = 0; i < length; i++)
+    {
+        const uint8_t symbol = slots[decoder.target_scaled(rans::scale_bits)];
+        decoder.decode(starts[symbol], freqs[symbol]);
+        out.push_back(symbol);
+    }
+}
+
+// [16bit length][range coded bits]
+void BinaryEncode::encode()
+{
+    if (in.empty()) {
+        return;
+    }
+
+    const auto length = static_cast<uint16_t>(in.size());
+    out.push_back(static_cast<uint8_t>(length & 0xFF));
+    out.push_back(static_cast<uint8_t>(length >> 8));
+
+    std::array<uint16_t, NO_OF_CHARS> probabilities;
+    probabilities.fill(BIT_PROBABILITY_HALF);
+    range_encoder encoder(out);
+    for (const auto ch : in)
+    {
+        for (int i = 7, node = 1; i >= 0; i--)
+        {
+            const int bit = ch >> i & 1;
+            encoder.encode_bit(probabilities[node], bit);
+            node = node << 1 | bit;
+        }
+    }
+    encoder.flush();
+}
+
+void BinaryDecode::decode()
+{
+    if (in.empty()) {
+        return;
+    }
+
+    if (in.size() < 2) {
+        throw std::runtime_error("Corrupted range coded stream");
+    }
+
+    const uint16_t length = in[0] | static_cast<uint16_t>(in[1] << 8);
+    const std::vector<uint8_t> data(in.begin() + 2, in.end());
+
+    std::array<uint16_t, NO_OF_CHARS> probabilities;
+    probabilities.fill(BIT_PROBABILITY_HALF);
+    range_decoder decoder(data);
+    out.reserve(out.size() + length);
+    for (uint32_t i = 0; i < length; i++)
+    {
+        int node = 1;
+        while (node < NO_OF_CHARS) {
+            node = node << 1 | decoder.decode_bit(probabilities[node]);
+        }
+        out.push_back(static_cast<uint8_t>(node - NO_OF_CHARS));
+    }
+}
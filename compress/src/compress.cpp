@@ -24,7 +24,11 @@
 #include "utils.h"
 #include "Huffman.h"
 #include "arithmetic.h"
+#include "context.h"
+#include "rans.h"
+#include "lz77.h"
 #include "repeator.h"
+#include "preset.h"
 #include <fstream>
 #include <thread>
 #include <chrono>
@@ -95,6 +99,12 @@ Arguments::predefined_args_t arguments = {
         .value_required = false,
         .explanation = "Disable LZW compression overlay on Arithmetical compression result"
     },
+    Arguments::single_arg_t {
+        .name = "no-lz77",
+        .short_name = 'X',
+        .value_required = false,
+        .explanation = "Disable LZ77 compression"
+    },
     Arguments::single_arg_t {
         .name = "archive",
         .short_name = 'A',
@@ -113,6 +123,42 @@ Arguments::predefined_args_t arguments = {
         .value_required = true,
         .explanation = "Set entropy threshold within [0, 8]"
     },
+    Arguments::single_arg_t {
+        .name = "lzw-max-bits",
+        .short_name = 'M',
+        .value_required = true,
+        .explanation = "Set maximum LZW code width within [12, 16] (default 16)"
+    },
+    Arguments::single_arg_t {
+        .name = "lzw-bits",
+        .short_name = 'N',
+        .value_required = true,
+        .explanation = "Also try fixed width LZW codes, plain and adaptively reset, comma separated widths within [9, 16] (e.g. 9,12)"
+    },
+    Arguments::single_arg_t {
+        .name = "solid",
+        .short_name = 'S',
+        .value_required = true,
+        .explanation = "Carry the LZW dictionary and Huffman table across groups of N blocks (default 1, no carrying)"
+    },
+    Arguments::single_arg_t {
+        .name = "unix",
+        .short_name = 'Z',
+        .value_required = false,
+        .explanation = "Write a compress(1) compatible .Z stream, -M then takes widths within [9, 16]"
+    },
+    Arguments::single_arg_t {
+        .name = "dict",
+        .short_name = 'D',
+        .value_required = true,
+        .explanation = "Prime the LZW dictionary of every group with a preset dictionary made by train"
+    },
+    Arguments::single_arg_t {
+        .name = "fast",
+        .short_name = 'F',
+        .value_required = false,
+        .explanation = "Only try the LZ77 codec, trading compression ratio for throughput (not with -X or -A)"
+    },
 };
 
 std::atomic < unsigned > thread_count = 1;
@@ -123,18 +169,29 @@ std::atomic < uint64_t > arithmetic_compressed_blocks = 0;
 std::atomic < uint64_t > arithmetic_lzw_compressed_blocks = 0;
 std::atomic < uint64_t > raw_blocks = 0;
 std::atomic < uint64_t > repeator_blocks = 0;
+std::atomic < uint64_t > lz77_blocks = 0;
 std::atomic < bool > disable_lzw = false;
 std::atomic < bool > disable_huffman = false;
 std::atomic < bool > disable_arithmetic = false;
 std::atomic < bool > disable_arithmetic_lzw = false;
+std::atomic < bool > disable_lz77 = false;
 std::map <uint8_t, uint64_t> global_frequency_map;
 std::map <uint8_t, uint64_t> lzw_frequency_map;
 std::map <uint8_t, uint64_t> huffman_frequency_map;
 std::map <uint8_t, uint64_t> arithmetic_frequency_map;
 std::map <uint8_t, uint64_t> arithmetic_lzw_frequency_map;
 std::map <uint8_t, uint64_t> repeator_frequency_map;
+std::map <uint8_t, uint64_t> lz77_frequency_map;
 std::map <uint8_t, uint64_t> raw_frequency_map;
 std::atomic < float > entropy_threshold = 7.5;
+std::atomic < unsigned > lzw_max_bits = LZW_VARIABLE_MAX_BIT_SIZE_MAX;
+std::vector < unsigned > lzw_fixed_bits;
+std::atomic < unsigned > solid_blocks = 1;
+std::atomic < bool > unix_compress = false;
+std::atomic < bool > use_preset = false;
+std::atomic < bool > fast_mode = false;
+preset::dictionary preset_dictionary;
+lzw_solid_dictionary primed_dictionary;
 
 long double entropy_of(const std::vector<uint8_t>& data, std::map <uint8_t, uint64_t> & frequency_map)
 {
@@ -179,7 +236,8 @@ inline void record_freq(const std::vector<uint8_t>& data, std::map <uint8_t, uin
     }
 }
 
-void compress_on_one_block(const std::vector<uint8_t> * in_buffer, std::vector<uint8_t> * out_buffer)
+void compress_on_one_block(const std::vector<uint8_t> * in_buffer, std::vector<uint8_t> * out_buffer,
+    lzw_solid_dictionary * solid_dictionary = nullptr, huffman_solid_table * huffman_table = nullptr)
 {
     std::vector < std::pair < std::vector<uint8_t> , uint8_t > > size_map;
     std::mutex mutex_in, mutex_out;
@@ -201,17 +259,107 @@ void compress_on_one_block(const std::vector<uint8_t> * in_buffer, std::vector<u
         output.insert(end(output), begin(compressed_data_lzw_tmp), end(compressed_data_lzw_tmp));
     };
 
+    auto LZWVariableCompress = [](std::vector<uint8_t> & input, std::vector<uint8_t> & output)->void
+    {
+        // [Max Code Width] [Codes]
+        const unsigned max_code_width = lzw_max_bits;
+        std::vector<uint8_t> compressed_data_lzw_tmp;
+        compressed_data_lzw_tmp.push_back(static_cast<uint8_t>(max_code_width));
+        lzw_dispatch(max_code_width, [&](auto max_bits)->void
+        {
+            lzw <decltype(max_bits)::value> compressor(input, compressed_data_lzw_tmp);
+            compressor.compress_variable();
+        });
+
+        const auto data_len_lzw_tmp = static_cast<uint16_t>(compressed_data_lzw_tmp.size());
+        output.reserve(compressed_data_lzw_tmp.size() + 2 + output.size());
+        output.push_back(reinterpret_cast<const uint8_t*>(&data_len_lzw_tmp)[0]);
+        output.push_back(reinterpret_cast<const uint8_t*>(&data_len_lzw_tmp)[1]);
+        output.insert(end(output), begin(compressed_data_lzw_tmp), end(compressed_data_lzw_tmp));
+    };
+
+    auto LZWSolidCompress = [](std::vector<uint8_t> & input, std::vector<uint8_t> & output,
+        lzw_solid_dictionary & dictionary)->void
+    {
+        // width is recorded once in the solid group header
+        std::vector<uint8_t> compressed_data_lzw_tmp;
+        lzw_dispatch(lzw_max_bits, [&](auto max_bits)->void
+        {
+            lzw <decltype(max_bits)::value> compressor(input, compressed_data_lzw_tmp, dictionary);
+            compressor.compress_variable();
+        });
+
+        const auto data_len_lzw_tmp = static_cast<uint16_t>(compressed_data_lzw_tmp.size());
+        output.reserve(compressed_data_lzw_tmp.size() + 2 + output.size());
+        output.push_back(reinterpret_cast<const uint8_t*>(&data_len_lzw_tmp)[0]);
+        output.push_back(reinterpret_cast<const uint8_t*>(&data_len_lzw_tmp)[1]);
+        output.insert(end(output), begin(compressed_data_lzw_tmp), end(compressed_data_lzw_tmp));
+    };
+
+    auto LZWFixedCompress = [](std::vector<uint8_t> & input, std::vector<uint8_t> & output,
+        const unsigned code_width, const bool adaptive)->void
+    {
+        // [Code Width] [Codes]
+        std::vector<uint8_t> compressed_data_lzw_tmp;
+        compressed_data_lzw_tmp.push_back(static_cast<uint8_t>(code_width));
+        lzw_dispatch(code_width, [&](auto bits)->void
+        {
+            lzw <decltype(bits)::value> compressor(input, compressed_data_lzw_tmp);
+            if (adaptive) {
+                compressor.compress_adaptive();
+            } else {
+                compressor.compress();
+            }
+        });
+
+        const auto data_len_lzw_tmp = static_cast<uint16_t>(compressed_data_lzw_tmp.size());
+        output.reserve(compressed_data_lzw_tmp.size() + 2 + output.size());
+        output.push_back(reinterpret_cast<const uint8_t*>(&data_len_lzw_tmp)[0]);
+        output.push_back(reinterpret_cast<const uint8_t*>(&data_len_lzw_tmp)[1]);
+        output.insert(end(output), begin(compressed_data_lzw_tmp), end(compressed_data_lzw_tmp));
+    };
+
     auto HuffmanCompress = [](std::vector<uint8_t> & input, std::vector<uint8_t> & output)->void
     {
-        // try huffman
+        // try huffman, canonical codes never exceed the 15-bit limit
         Huffman huffmanCompressor(input, output);
-        huffmanCompressor.compress();
+        huffmanCompressor.compress_canonical();
+    };
+
+    auto HuffmanPureCompress = [](std::vector<uint8_t> & input, std::vector<uint8_t> & output, const bool interleaved)->void
+    {
+        std::vector<uint8_t> out;
+        Huffman huffmanCompressor(input, out);
+        if (interleaved) {
+            huffmanCompressor.compress_interleaved();
+        } else {
+            huffmanCompressor.compress_canonical();
+        }
+
+        const auto data_len_huffman = static_cast<uint16_t>(out.size());
+        output.push_back(reinterpret_cast<const uint8_t *>(&data_len_huffman)[0]);
+        output.push_back(reinterpret_cast<const uint8_t *>(&data_len_huffman)[1]);
+        output.insert(end(output), begin(out), end(out));
+    };
+
+    auto HuffmanSolidCompress = [](std::vector<uint8_t> & input, std::vector<uint8_t> & output,
+        const bool interleaved, huffman_solid_table & table)->bool
+    {
+        std::vector<uint8_t> out;
+        Huffman huffmanCompressor(input, out, table);
+        const bool repeated = huffmanCompressor.compress_solid(interleaved);
+
+        const auto data_len_huffman = static_cast<uint16_t>(out.size());
+        output.push_back(reinterpret_cast<const uint8_t *>(&data_len_huffman)[0]);
+        output.push_back(reinterpret_cast<const uint8_t *>(&data_len_huffman)[1]);
+        output.insert(end(output), begin(out), end(out));
+        return repeated;
     };
 
     auto ArithmeticCompress = [](const std::vector<uint8_t> & input, std::vector<uint8_t> & output)->void
     {
         std::vector<uint8_t> in = input, out;
-        arithmetic::Encode compressor(in, out);
+        arithmetic::RangeEncode compressor(in, out);
         compressor.encode();
 
         const auto data_len_arithmetic = static_cast<uint16_t>(out.size());
@@ -220,6 +368,66 @@ void compress_on_one_block(const std::vector<uint8_t> * in_buffer, std::vector<u
         output.insert(end(output), begin(out), end(out));
     };
 
+    auto ArithmeticStaticCompress = [](const std::vector<uint8_t> & input, std::vector<uint8_t> & output)->void
+    {
+        std::vector<uint8_t> in = input, out;
+        arithmetic::StaticEncode compressor(in, out);
+        compressor.encode();
+
+        const auto data_len_static = static_cast<uint16_t>(out.size());
+        output.push_back(reinterpret_cast<const uint8_t *>(&data_len_static)[0]);
+        output.push_back(reinterpret_cast<const uint8_t *>(&data_len_static)[1]);
+        output.insert(end(output), begin(out), end(out));
+    };
+
+    auto ArithmeticBinaryCompress = [](const std::vector<uint8_t> & input, std::vector<uint8_t> & output)->void
+    {
+        std::vector<uint8_t> in = input, out;
+        arithmetic::BinaryEncode compressor(in, out);
+        compressor.encode();
+
+        const auto data_len_binary = static_cast<uint16_t>(out.size());
+        output.push_back(reinterpret_cast<const uint8_t *>(&data_len_binary)[0]);
+        output.push_back(reinterpret_cast<const uint8_t *>(&data_len_binary)[1]);
+        output.insert(end(output), begin(out), end(out));
+    };
+
+    auto ContextCompress = [](const std::vector<uint8_t> & input, std::vector<uint8_t> & output, const int order)->void
+    {
+        std::vector<uint8_t> in = input, out;
+        arithmetic::ContextEncode compressor(in, out, order);
+        compressor.encode();
+
+        const auto data_len_context = static_cast<uint16_t>(out.size());
+        output.push_back(reinterpret_cast<const uint8_t *>(&data_len_context)[0]);
+        output.push_back(reinterpret_cast<const uint8_t *>(&data_len_context)[1]);
+        output.insert(end(output), begin(out), end(out));
+    };
+
+    auto RANSCompress = [](const std::vector<uint8_t> & input, std::vector<uint8_t> & output)->void
+    {
+        std::vector<uint8_t> in = input, out;
+        rans::rans compressor(in, out);
+        compressor.encode();
+
+        const auto data_len_rans = static_cast<uint16_t>(out.size());
+        output.push_back(reinterpret_cast<const uint8_t *>(&data_len_rans)[0]);
+        output.push_back(reinterpret_cast<const uint8_t *>(&data_len_rans)[1]);
+        output.insert(end(output), begin(out), end(out));
+    };
+
+    auto LZ77Compress = [](const std::vector<uint8_t> & input, std::vector<uint8_t> & output)->void
+    {
+        std::vector<uint8_t> in = input, out;
+        lz77::lz77 compressor(in, out);
+        compressor.encode();
+
+        const auto data_len_lz77 = static_cast<uint16_t>(out.size());
+        output.push_back(reinterpret_cast<const uint8_t *>(&data_len_lz77)[0]);
+        output.push_back(reinterpret_cast<const uint8_t *>(&data_len_lz77)[1]);
+        output.insert(end(output), begin(out), end(out));
+    };
+
     auto CopyOver = [](std::vector < uint8_t > & in_buffer, std::vector < uint8_t > & out_buffer)->void
     {
         const auto raw_block_size = static_cast<uint16_t>(in_buffer.size());
@@ -238,14 +446,54 @@ void compress_on_one_block(const std::vector<uint8_t> * in_buffer, std::vector<u
             in = *in_buffer;
         }
 
-        LZW9Compress(in, out);
+        LZWVariableCompress(in, out);
+
+        {
+            std::lock_guard lock(mutex_out);
+            size_map.emplace_back(out, used_lzw_variable);
+        }
+    };
+
+    // the carried dictionary only moves on if the block ends up solid, so the trial runs on a copy
+    lzw_solid_dictionary solid_trial;
+    auto compression_lzw_solid_block = [&]()->void
+    {
+        std::vector<uint8_t> in, out;
+
+        {
+            std::lock_guard lock(mutex_in);
+            in = *in_buffer;
+        }
+
+        lzw_solid_dictionary dictionary = *solid_dictionary;
+        LZWSolidCompress(in, out, dictionary);
+
+        {
+            std::lock_guard lock(mutex_out);
+            size_map.emplace_back(out, used_lzw_solid);
+            solid_trial = std::move(dictionary);
+        }
+    };
+
+    auto compression_lzw_fixed_block = [&](const unsigned code_width, const bool adaptive)->void
+    {
+        std::vector<uint8_t> in, out;
+
+        {
+            std::lock_guard lock(mutex_in);
+            in = *in_buffer;
+        }
+
+        LZWFixedCompress(in, out, code_width, adaptive);
 
         {
             std::lock_guard lock(mutex_out);
-            size_map.emplace_back(out, used_lzw);
+            size_map.emplace_back(out, adaptive ? used_lzw_adaptive : used_lzw_fixed);
         }
     };
 
+    // same as the LZW dictionary, the carried table only moves on if the block ends up with it
+    huffman_solid_table huffman_trial;
     auto compression_huffman_block = [&]()->void
     {
         std::vector<uint8_t> in, out, out2;
@@ -258,9 +506,28 @@ void compress_on_one_block(const std::vector<uint8_t> * in_buffer, std::vector<u
         HuffmanCompress(in, out);
         LZW9Compress(out, out2);
 
+        // the overlay does not always pay for itself, and without it a block decodes at table lookup speed,
+        // larger blocks are split into four streams that decode side by side
+        std::vector<uint8_t> pure;
+        const bool interleaved = in.size() >= Huffman::interleaved_min_size;
+        uint8_t pure_method = interleaved ? used_huffman_interleaved : used_huffman_pure;
+        huffman_solid_table table;
+        if (huffman_table)
+        {
+            // within a solid group the table of an earlier block can be reused, and left out
+            table = *huffman_table;
+            if (HuffmanSolidCompress(in, pure, interleaved, table)) {
+                pure_method = interleaved ? used_huffman_interleaved_repeat : used_huffman_repeat;
+            }
+        } else {
+            HuffmanPureCompress(in, pure, interleaved);
+        }
+
         {
             std::lock_guard lock(mutex_out);
-            size_map.emplace_back(out2, used_huffman);
+            size_map.emplace_back(out2, used_huffman_canonical);
+            size_map.emplace_back(pure, pure_method);
+            huffman_trial = table;
         }
     };
 
@@ -283,13 +550,93 @@ void compress_on_one_block(const std::vector<uint8_t> * in_buffer, std::vector<u
 
             {
                 std::lock_guard lock(mutex_out);
-                size_map.emplace_back(lzw_overlay_out, used_arithmetic_lzw);
+                size_map.emplace_back(lzw_overlay_out, used_arithmetic_range_lzw);
             }
         }
 
         {
             std::lock_guard lock(mutex_out);
-            size_map.emplace_back(out, used_arithmetic);
+            size_map.emplace_back(out, used_arithmetic_range);
+        }
+    };
+
+    // a fixed model from the block histogram, nothing is updated while decoding
+    auto compression_arithmetic_static_block = [&]()->void
+    {
+        std::vector<uint8_t> in, out; {
+            std::lock_guard lock(mutex_in);
+            in = *in_buffer;
+        }
+
+        ArithmeticStaticCompress(in, out);
+
+        {
+            std::lock_guard lock(mutex_out);
+            size_map.emplace_back(out, used_arithmetic_static);
+        }
+    };
+
+    // bitwise decisions adapt fast, which pays off where the statistics shift within a block
+    auto compression_arithmetic_binary_block = [&]()->void
+    {
+        std::vector<uint8_t> in, out; {
+            std::lock_guard lock(mutex_in);
+            in = *in_buffer;
+        }
+
+        ArithmeticBinaryCompress(in, out);
+
+        {
+            std::lock_guard lock(mutex_out);
+            size_map.emplace_back(out, used_arithmetic_binary);
+        }
+    };
+
+    // text and logs are far better predicted by the byte or two before
+    auto compression_context_block = [&](const int order)->void
+    {
+        std::vector<uint8_t> in, out; {
+            std::lock_guard lock(mutex_in);
+            in = *in_buffer;
+        }
+
+        ContextCompress(in, out, order);
+
+        {
+            std::lock_guard lock(mutex_out);
+            size_map.emplace_back(out, order == 1 ? used_arithmetic_order1 : used_arithmetic_order2);
+        }
+    };
+
+    // static model, close to arithmetic coding in size and decodes with one table lookup per symbol
+    auto compression_rans_block = [&]()->void
+    {
+        std::vector<uint8_t> in, out; {
+            std::lock_guard lock(mutex_in);
+            in = *in_buffer;
+        }
+
+        RANSCompress(in, out);
+
+        {
+            std::lock_guard lock(mutex_out);
+            size_map.emplace_back(out, used_rans);
+        }
+    };
+
+    // byte aligned and without any entropy coding, far from the smallest but by far the fastest both ways
+    auto compression_lz77_block = [&]()->void
+    {
+        std::vector<uint8_t> in, out; {
+            std::lock_guard lock(mutex_in);
+            in = *in_buffer;
+        }
+
+        LZ77Compress(in, out);
+
+        {
+            std::lock_guard lock(mutex_out);
+            size_map.emplace_back(out, used_lz77);
         }
     };
 
@@ -334,7 +681,10 @@ void compress_on_one_block(const std::vector<uint8_t> * in_buffer, std::vector<u
     };
 
     bool disable_compression = false;
-    if (!(disable_lzw && disable_huffman && disable_arithmetic))
+    if (fast_mode) {
+        // throughput first, LZ77 runs alone below without the entropy estimate or any thread
+        disable_compression = true;
+    } else if (!(disable_lzw && disable_huffman && disable_arithmetic && disable_lz77))
     {
         if (const auto current_entropy = entropy_of(*in_buffer);
             current_entropy > entropy_threshold)
@@ -348,7 +698,24 @@ void compress_on_one_block(const std::vector<uint8_t> * in_buffer, std::vector<u
     std::vector < std::thread > thread_compression;
 
     if (!disable_compression && !disable_lzw) {
-        thread_compression.emplace_back(compression_lzw_block);
+        // as long as nothing has been carried over, a solid block comes out the same as a plain variable width one
+        if (solid_dictionary) {
+            thread_compression.emplace_back(compression_lzw_solid_block);
+        }
+
+        if (!solid_dictionary || !solid_dictionary->slots.empty()) {
+            thread_compression.emplace_back(compression_lzw_block);
+        }
+
+        // a frozen dictionary wins on uniform data, resetting it once it goes stale wins on everything else
+        for (const auto code_width : lzw_fixed_bits) {
+            thread_compression.emplace_back(compression_lzw_fixed_block, code_width, false);
+            thread_compression.emplace_back(compression_lzw_fixed_block, code_width, true);
+        }
+    }
+
+    if (!disable_compression && !disable_lz77) {
+        thread_compression.emplace_back(compression_lz77_block);
     }
 
     if (!disable_compression && !disable_huffman) {
@@ -357,11 +724,22 @@ void compress_on_one_block(const std::vector<uint8_t> * in_buffer, std::vector<u
 
     if (!disable_compression && !disable_arithmetic) {
         thread_compression.emplace_back(compression_arithmetic_block);
+        thread_compression.emplace_back(compression_arithmetic_static_block);
+        thread_compression.emplace_back(compression_arithmetic_binary_block);
+        thread_compression.emplace_back(compression_rans_block);
+        thread_compression.emplace_back(compression_context_block, 1);
+        thread_compression.emplace_back(compression_context_block, 2);
+    }
+
+    if (fast_mode) {
+        compression_lz77_block();
     }
 
     // if (disable_compression) {
     no_compression();
-    repeator();
+    if (!fast_mode) {
+        repeator();
+    }
     // }
 
     // external huffman calculation
@@ -392,6 +770,14 @@ void compress_on_one_block(const std::vector<uint8_t> * in_buffer, std::vector<u
         throw std::runtime_error("Unknown error occurred");
     }
 
+    if (compression_method == used_lzw_solid) {
+        *solid_dictionary = std::move(solid_trial);
+    }
+
+    if (huffman_table && (compression_method == used_huffman_pure || compression_method == used_huffman_interleaved)) {
+        *huffman_table = huffman_trial;
+    }
+
     out_buffer->reserve(BLOCK_SIZE);
     out_buffer->push_back(compression_method);
     out_buffer->push_back(calculate_8bit(*compression_buffer));
@@ -399,16 +785,24 @@ void compress_on_one_block(const std::vector<uint8_t> * in_buffer, std::vector<u
 
     if (verbose)
     {
-        if (compression_method == used_lzw) {
+        if (compression_method == used_lzw || compression_method == used_lzw_variable
+            || compression_method == used_lzw_fixed || compression_method == used_lzw_adaptive
+            || compression_method == used_lzw_solid) {
             record_freq(*compression_buffer, lzw_frequency_map);
             ++lzw_compressed_blocks;
-        } else if (compression_method == used_huffman) {
+        } else if (compression_method == used_huffman || compression_method == used_huffman_canonical
+            || compression_method == used_huffman_interleaved || compression_method == used_huffman_pure
+            || compression_method == used_huffman_repeat || compression_method == used_huffman_interleaved_repeat) {
             record_freq(*compression_buffer, huffman_frequency_map);
             ++huffman_compressed_blocks;
-        } else if (compression_method == used_arithmetic) {
+        } else if (compression_method == used_arithmetic || compression_method == used_arithmetic_range
+            || compression_method == used_arithmetic_static || compression_method == used_arithmetic_binary
+            || compression_method == used_rans
+            || compression_method == used_arithmetic_order1
+            || compression_method == used_arithmetic_order2) {
             record_freq(*compression_buffer, arithmetic_frequency_map);
             ++arithmetic_compressed_blocks;
-        } else if (compression_method == used_arithmetic_lzw) {
+        } else if (compression_method == used_arithmetic_lzw || compression_method == used_arithmetic_range_lzw) {
             record_freq(*compression_buffer, arithmetic_lzw_frequency_map);
             ++arithmetic_lzw_compressed_blocks;
             ++arithmetic_compressed_blocks;
@@ -418,6 +812,9 @@ void compress_on_one_block(const std::vector<uint8_t> * in_buffer, std::vector<u
         } else if (compression_method == used_repeator) {
             record_freq(*compression_buffer, repeator_frequency_map);
             ++repeator_blocks;
+        } else if (compression_method == used_lz77) {
+            record_freq(*compression_buffer, lz77_frequency_map);
+            ++lz77_blocks;
         }
     }
 }
@@ -425,40 +822,81 @@ void compress_on_one_block(const std::vector<uint8_t> * in_buffer, std::vector<u
 std::atomic < int64_t > processed_size = 0;
 std::atomic < int64_t > compressed_size = 0;
 
+void compress_on_one_job(const std::vector < std::vector<uint8_t> > * in_blocks, std::vector<uint8_t> * out_buffer)
+{
+    if (solid_blocks == 1 && !use_preset) {
+        compress_on_one_block(&in_blocks->front(), out_buffer);
+        return;
+    }
+
+    // [16bit Size] [16bit Block Count] [Max Code Width] ([32bit Preset Dictionary ID]), the blocks follow
+    std::vector<uint8_t> group_header;
+    const auto header_size = static_cast<uint16_t>(use_preset ? 7 : 3);
+    const auto block_count = static_cast<uint16_t>(in_blocks->size());
+    group_header.push_back(reinterpret_cast<const uint8_t*>(&header_size)[0]);
+    group_header.push_back(reinterpret_cast<const uint8_t*>(&header_size)[1]);
+    group_header.push_back(reinterpret_cast<const uint8_t*>(&block_count)[0]);
+    group_header.push_back(reinterpret_cast<const uint8_t*>(&block_count)[1]);
+    group_header.push_back(static_cast<uint8_t>(lzw_max_bits));
+    if (use_preset) {
+        for (unsigned i = 0; i < sizeof(preset_dictionary.id); i++) {
+            group_header.push_back(reinterpret_cast<const uint8_t*>(&preset_dictionary.id)[i]);
+        }
+    }
+
+    out_buffer->push_back(used_solid_group);
+    out_buffer->push_back(calculate_8bit(group_header));
+    out_buffer->insert(end(*out_buffer), begin(group_header), end(group_header));
+
+    // blocks of one group go in order, every one of them can pick up where the last solid block left the dictionary
+    lzw_solid_dictionary dictionary = use_preset ? primed_dictionary : lzw_solid_dictionary { };
+    huffman_solid_table huffman_table;
+    for (const auto & in_block : *in_blocks)
+    {
+        std::vector<uint8_t> out_block;
+        compress_on_one_block(&in_block, &out_block, &dictionary, &huffman_table);
+        out_buffer->insert(end(*out_buffer), begin(out_block), end(out_block));
+    }
+}
+
 bool compress(std::basic_istream<char>& input, std::basic_ostream<char>& output)
 {
     if (!input.good()) {
         return false;
     }
 
-    std::vector < std::vector<uint8_t> > in_buffers;
+    std::vector < std::vector < std::vector<uint8_t> > > in_jobs;
     std::vector < std::vector<uint8_t> > out_buffers;
     std::vector < std::thread > threads;
-    in_buffers.resize(thread_count);
+    in_jobs.resize(thread_count);
     out_buffers.resize(thread_count);
 
-    // read in queue
-    for (unsigned i = 0; i < thread_count; ++i)
+    // read in queue, one job is one block, or one solid group of blocks
+    bool end_of_input = false;
+    for (unsigned i = 0; i < thread_count && !end_of_input; ++i)
     {
-        auto & in_buffer = in_buffers[i];
-        in_buffer.resize(BLOCK_SIZE);
-        input.read(reinterpret_cast<char*>(in_buffer.data()), static_cast<std::streamsize>(in_buffer.size()));
-        const auto actual_size = input.gcount();
-        if (actual_size == 0) {
-            in_buffer.clear();
-            break;
-        }
-        if (verbose) {
-            processed_size += actual_size;
+        for (unsigned block = 0; block < solid_blocks; ++block)
+        {
+            std::vector<uint8_t> in_buffer(BLOCK_SIZE);
+            input.read(reinterpret_cast<char*>(in_buffer.data()), static_cast<std::streamsize>(in_buffer.size()));
+            const auto actual_size = input.gcount();
+            if (actual_size == 0) {
+                end_of_input = true;
+                break;
+            }
+            if (verbose) {
+                processed_size += actual_size;
+            }
+            in_buffer.resize(actual_size);
+            in_jobs[i].emplace_back(std::move(in_buffer));
         }
-        in_buffer.resize(actual_size);
     }
 
     // create workers
     for (unsigned i = 0; i < thread_count; ++i)
     {
-        if (!in_buffers[i].empty()) {
-            threads.emplace_back(compress_on_one_block, &in_buffers[i], &out_buffers[i]);
+        if (!in_jobs[i].empty()) {
+            threads.emplace_back(compress_on_one_job, &in_jobs[i], &out_buffers[i]);
         }
     }
 
@@ -484,10 +922,53 @@ bool compress(std::basic_istream<char>& input, std::basic_ostream<char>& output)
     return true;
 }
 
+// compress(1) stream, one LZW run over the whole input, read in chunks
+void compress_unix(std::basic_istream<char>& input, std::basic_ostream<char>& output)
+{
+    const unsigned max_bits = lzw_max_bits;
+    const unsigned char header[] = { unix_magic[0], unix_magic[1], static_cast<unsigned char>(unix_block_mode | max_bits) };
+    output.write(reinterpret_cast<const char *>(header), sizeof(header));
+    if (verbose) {
+        compressed_size += sizeof(header);
+    }
+
+    lzw_solid_dictionary dictionary;
+    std::vector<uint8_t> in_buffer, out_buffer;
+    lzw_dispatch(max_bits, [&](auto bits)->void
+    {
+        bool last_chunk = false;
+        while (!last_chunk)
+        {
+            in_buffer.resize(LZW_UNIX_CHUNK_SIZE);
+            input.read(reinterpret_cast<char*>(in_buffer.data()), static_cast<std::streamsize>(in_buffer.size()));
+            const auto actual_size = input.gcount();
+            in_buffer.resize(actual_size);
+            last_chunk = !input.good();
+
+            lzw <decltype(bits)::value> compressor(in_buffer, out_buffer, dictionary);
+            compressor.compress_unix(last_chunk);
+            output.write(reinterpret_cast<char*>(out_buffer.data()), static_cast<std::streamsize>(out_buffer.size()));
+
+            if (verbose) {
+                processed_size += actual_size;
+                compressed_size += static_cast<int64_t>(out_buffer.size());
+            }
+
+            out_buffer.clear();
+        }
+    });
+}
+
 void compress_from_stdin()
 {
     // Set stdin and stdout to binary mode
     set_binary();
+    if (unix_compress) {
+        compress_unix(std::cin, std::cout);
+        std::cout.flush();
+        return;
+    }
+
     std::cout.write(reinterpret_cast<const char *>(magic), sizeof(magic));
     std::cout.write(reinterpret_cast<char *>(&BLOCK_SIZE), sizeof(BLOCK_SIZE));
 
@@ -543,6 +1024,11 @@ void compress_file(const std::string& in, const std::string& out)
         throw std::runtime_error("Failed to open output file: " + out);
     }
 
+    if (unix_compress) {
+        compress_unix(input_file, output_file);
+        return;
+    }
+
     std::vector < uint64_t > seconds_left_sample_space;
     const auto before = std::chrono::system_clock::now();
 
@@ -695,6 +1181,7 @@ int main(const int argc, const char** argv)
                 add_freq_map(arithmetic_lzw_frequency_map);
                 add_freq_map(raw_frequency_map);
                 add_freq_map(repeator_frequency_map);
+                add_freq_map(lz77_frequency_map);
 
                 const auto compressed_entropy = entropy_of({}, compressed_data_freq);
                 const auto entropy = entropy_of({}, global_frequency_map);
@@ -708,8 +1195,8 @@ int main(const int argc, const char** argv)
                 const auto actual_used_bits = compressed_size * 8;
                 const auto expectation_ratio = (numerical_bits_expectation != 0 ?
                     static_cast<long double>(actual_used_bits) / static_cast<long double>(numerical_bits_expectation) : NAN);
-                const auto total_blocks = lzw_compressed_blocks + huffman_compressed_blocks + arithmetic_compressed_blocks + raw_blocks + repeator_blocks;
-                const auto compressed_blocks = lzw_compressed_blocks + huffman_compressed_blocks + arithmetic_compressed_blocks + repeator_blocks;
+                const auto total_blocks = lzw_compressed_blocks + huffman_compressed_blocks + arithmetic_compressed_blocks + raw_blocks + repeator_blocks + lz77_blocks;
+                const auto compressed_blocks = lzw_compressed_blocks + huffman_compressed_blocks + arithmetic_compressed_blocks + repeator_blocks + lz77_blocks;
                 const auto compression_ratio = (static_cast<double>(processed_size) - static_cast<double>(compressed_size)) / static_cast<double>(processed_size);
                 const auto CORatio = static_cast<double>(compressed_size) / static_cast<double>(processed_size);
                 const auto CRRatio = (raw_blocks != 0 ? static_cast<double>(compressed_blocks) / static_cast<double>(raw_blocks) : NAN);
@@ -776,6 +1263,8 @@ int main(const int argc, const char** argv)
                 split_add("     - Arithmetic Bare Entropy", arithmetic_entropy_literal);
                 add_entry(" - Repeator Blocks", literalize(repeator_blocks), "");
                 split_add("   - Repeator Entropy", literalize(entropy_of({}, repeator_frequency_map)));
+                add_entry(" - LZ77 Blocks", literalize(lz77_blocks), "");
+                split_add("   - LZ77 Entropy", literalize(entropy_of({}, lz77_frequency_map)));
                 add_entry("Raw Blocks", raw_blocks_literal, "");
                 split_add(" - Raw Block Entropy", raw_entropy_literal);
                 add_entry("Compressed/Raw", CRRatio_literal, "%");
@@ -832,9 +1321,16 @@ int main(const int argc, const char** argv)
         disable_huffman = static_cast<Arguments::args_t>(args).contains("no-huffman");
         disable_arithmetic = static_cast<Arguments::args_t>(args).contains("no-arithmetic");
         disable_arithmetic_lzw = static_cast<Arguments::args_t>(args).contains("no-lzw-overlay");
+        disable_lz77 = static_cast<Arguments::args_t>(args).contains("no-lz77");
 
         if (static_cast<Arguments::args_t>(args).contains("archive")) {
-            disable_arithmetic = disable_lzw = disable_huffman = true;
+            disable_arithmetic = disable_lzw = disable_huffman = disable_lz77 = true;
+        }
+
+        // fast mode runs LZ77 and nothing else, so it has to be left enabled
+        fast_mode = static_cast<Arguments::args_t>(args).contains("fast");
+        if (fast_mode && disable_lz77) {
+            throw std::runtime_error("--fast only runs LZ77, it cannot be combined with --no-lz77 or --archive");
         }
 
         if (static_cast<Arguments::args_t>(args).contains("block-size"))
@@ -858,6 +1354,68 @@ int main(const int argc, const char** argv)
             }
         }
 
+        unix_compress = static_cast<Arguments::args_t>(args).contains("unix");
+
+        if (static_cast<Arguments::args_t>(args).contains("lzw-max-bits"))
+        {
+            const auto lzw_max_bits_literal =
+                static_cast<Arguments::args_t>(args).at("lzw-max-bits").back();
+            const unsigned lzw_max_bits_min = unix_compress ? LZW_UNIX_MAX_BIT_SIZE_MIN : LZW_VARIABLE_MAX_BIT_SIZE_MIN;
+            lzw_max_bits = std::strtoul(lzw_max_bits_literal.c_str(), nullptr, 10);
+            if (lzw_max_bits < lzw_max_bits_min or lzw_max_bits > LZW_VARIABLE_MAX_BIT_SIZE_MAX) {
+                throw std::runtime_error("Invalid LZW code width " + lzw_max_bits_literal
+                    + ": Width is within the interval ["
+                    + std::to_string(lzw_max_bits_min) + ", "
+                    + std::to_string(LZW_VARIABLE_MAX_BIT_SIZE_MAX) + "]");
+            }
+        }
+
+        if (static_cast<Arguments::args_t>(args).contains("lzw-bits"))
+        {
+            const auto lzw_bits_literals = static_cast<Arguments::args_t>(args).at("lzw-bits");
+            for (const auto & lzw_bits_literal : lzw_bits_literals)
+            {
+                std::stringstream ss(lzw_bits_literal);
+                std::string width_literal;
+                while (std::getline(ss, width_literal, ','))
+                {
+                    const auto width = static_cast<unsigned>(std::strtoul(width_literal.c_str(), nullptr, 10));
+                    if (width < LZW_FIXED_BIT_SIZE_MIN or width > LZW_FIXED_BIT_SIZE_MAX) {
+                        throw std::runtime_error("Invalid LZW code width " + width_literal
+                            + ": Width is within the interval ["
+                            + std::to_string(LZW_FIXED_BIT_SIZE_MIN) + ", "
+                            + std::to_string(LZW_FIXED_BIT_SIZE_MAX) + "]");
+                    }
+
+                    if (std::ranges::find(lzw_fixed_bits, width) == end(lzw_fixed_bits)) {
+                        lzw_fixed_bits.push_back(width);
+                    }
+                }
+            }
+        }
+
+        if (static_cast<Arguments::args_t>(args).contains("solid"))
+        {
+            const auto solid_literal =
+                static_cast<Arguments::args_t>(args).at("solid").back();
+            solid_blocks = std::strtoul(solid_literal.c_str(), nullptr, 10);
+            if (solid_blocks < 1 or solid_blocks > SOLID_GROUP_BLOCKS_MAX) {
+                throw std::runtime_error("Invalid solid group size " + solid_literal
+                    + ": Size is within the interval [1, " + std::to_string(SOLID_GROUP_BLOCKS_MAX) + "]");
+            }
+        }
+
+        if (static_cast<Arguments::args_t>(args).contains("dict"))
+        {
+            if (unix_compress) {
+                throw std::invalid_argument("Preset dictionaries do not apply to .Z streams");
+            }
+
+            preset_dictionary = preset::load(static_cast<Arguments::args_t>(args).at("dict").back());
+            primed_dictionary = preset::prime(preset_dictionary, lzw_max_bits);
+            use_preset = true;
+        }
+
         if (static_cast<Arguments::args_t>(args).contains("input"))
         {
 			const auto input_file = static_cast<Arguments::args_t>(args).at("input");
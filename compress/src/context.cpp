@@ -0,0 +1,213 @@
+/* context.cpp
+ *
+ * Copyright 2025 Anivice Ives
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "context.h"
+#include <stdexcept>
+#include <utility>
+
+using namespace arithmetic;
+
+void context_entry::add(const uint8_t symbol)
+{
+    symbols.push_back({ symbol, CONTEXT_INCREMENT });
+    count_sum += CONTEXT_INCREMENT;
+}
+
+void context_entry::increment(const uint64_t index)
+{
+    symbols[index].count += CONTEXT_INCREMENT;
+    count_sum += CONTEXT_INCREMENT;
+
+    // keep frequent symbols near the front, where the linear search finds them first
+    if (index > 0 && symbols[index].count > symbols[index - 1].count) {
+        std::swap(symbols[index], symbols[index - 1]);
+    }
+
+    if (count_sum > CONTEXT_MAX_COUNT)
+    {
+        count_sum = 0;
+        for (auto & [symbol, count] : symbols)
+        {
+            count = static_cast<uint16_t>((count + 1) / 2);
+            count_sum += count;
+        }
+    }
+}
+
+ContextModel::ContextModel(const int order_) : order(order_)
+{
+    if (order != 1 && order != 2) {
+        throw std::invalid_argument("Context order can only be 1 or 2");
+    }
+
+    order1_slots.resize(256, -1);
+    if (order == 2) {
+        order2_slots.resize(1u << CONTEXT_ORDER2_HASH_BITS, -1);
+    }
+}
+
+int ContextModel::levels(int32_t ** slots)
+{
+    int count = 0;
+    if (order == 2)
+    {
+        const uint32_t key = static_cast<uint32_t>(previous2) << 8 | previous1;
+        slots[count++] = &order2_slots[key * 2654435761u >> (32 - CONTEXT_ORDER2_HASH_BITS)];
+    }
+
+    slots[count++] = &order1_slots[previous1];
+    return count;
+}
+
+void ContextModel::update(int32_t ** slots, const int found_level, const int level_count, const uint8_t symbol)
+{
+    for (int level = 0; level < found_level && level < level_count; level++)
+    {
+        if (*slots[level] < 0)
+        {
+            *slots[level] = static_cast<int32_t>(contexts.size());
+            contexts.emplace_back();
+        }
+        contexts[*slots[level]].add(symbol);
+    }
+
+    previous2 = previous1;
+    previous1 = symbol;
+}
+
+void ContextEncode::encode()
+{
+    if (in.empty()) {
+        return;
+    }
+
+    auto encode_symbol = [&](const int symbol) // a byte, or -1 for the end
+    {
+        int32_t * slots[2];
+        const int level_count = levels(slots);
+        int found_level = level_count;
+
+        for (int level = 0; level < level_count; level++)
+        {
+            if (*slots[level] < 0) {
+                continue; // nothing to escape from
+            }
+
+            auto & context = contexts[*slots[level]];
+            uint32_t start = 0;
+            uint64_t index = 0;
+            while (index < context.symbols.size() && context.symbols[index].symbol != symbol) {
+                start += context.symbols[index++].count;
+            }
+
+            if (index < context.symbols.size())
+            {
+                encoder.encode(start, context.symbols[index].count, context.total());
+                context.increment(index);
+                found_level = level;
+                break;
+            }
+
+            encoder.encode(context.count_sum, static_cast<uint32_t>(context.symbols.size()), context.total());
+        }
+
+        if (found_level == level_count)
+        {
+            const int sym_index = symbol < 0 ? EOF_SYMBOL : char_to_index[symbol];
+            const auto start = static_cast<uint32_t>(cum_freq(sym_index));
+            encoder.encode(start, static_cast<uint32_t>(cum_freq(sym_index - 1)) - start, static_cast<uint32_t>(total()));
+            if (symbol < 0) {
+                return;
+            }
+            update_tables(sym_index);
+        }
+
+        update(slots, found_level, level_count, static_cast<uint8_t>(symbol));
+    };
+
+    for (const auto ch : in) {
+        encode_symbol(ch);
+    }
+    encode_symbol(-1);
+    encoder.flush();
+}
+
+void ContextDecode::decode()
+{
+    if (in.empty()) {
+        return;
+    }
+
+    const auto out_begin = out.size();
+    range_decoder decoder(in);
+    while (true)
+    {
+        int32_t * slots[2];
+        const int level_count = levels(slots);
+        int found_level = level_count;
+        uint8_t symbol = 0;
+
+        for (int level = 0; level < level_count; level++)
+        {
+            if (*slots[level] < 0) {
+                continue;
+            }
+
+            auto & context = contexts[*slots[level]];
+            const uint32_t target = decoder.target(context.total());
+            if (target >= context.count_sum)
+            {
+                decoder.decode(context.count_sum, static_cast<uint32_t>(context.symbols.size()));
+                continue;
+            }
+
+            uint32_t start = 0;
+            uint64_t index = 0;
+            while (target >= start + context.symbols[index].count) {
+                start += context.symbols[index++].count;
+            }
+
+            decoder.decode(start, context.symbols[index].count);
+            symbol = context.symbols[index].symbol;
+            context.increment(index);
+            found_level = level;
+            break;
+        }
+
+        if (found_level == level_count)
+        {
+            const int sym_index = find_symbol(static_cast<int>(decoder.target(static_cast<uint32_t>(total()))));
+            const auto start = static_cast<uint32_t>(cum_freq(sym_index));
+            decoder.decode(start, static_cast<uint32_t>(cum_freq(sym_index - 1)) - start);
+            if (sym_index == EOF_SYMBOL) {
+                break;
+            }
+            symbol = index_to_char[sym_index];
+            update_tables(sym_index);
+        }
+
+        // no block is longer than this, a stream that keeps going past it is corrupted
+        if (out.size() - out_begin == UINT16_MAX) {
+            throw std::runtime_error("Corrupted range coded stream");
+        }
+        out.push_back(symbol);
+        update(slots, found_level, level_count, symbol);
+    }
+}
@@ -28,8 +28,15 @@
 #include "Huffman.h"
 #include <filesystem>
 #include "arithmetic.h"
+#include "context.h"
+#include "rans.h"
+#include "lz77.h"
 #include "repeator.h"
+#include "preset.h"
 #include <functional>
+#include <ranges>
+#include <cstring>
+#include <set>
 
 namespace fs = std::filesystem;
 
@@ -76,11 +83,27 @@ Arguments::predefined_args_t arguments = {
         .value_required = false,
         .explanation = "This flag is deprecated and has no effect"
     },
+    Arguments::single_arg_t {
+        .name = "unix",
+        .short_name = 'Z',
+        .value_required = false,
+        .explanation = "Read the input as a compress(1) .Z stream (detected automatically unless its width is 9 without block mode)"
+    },
+    Arguments::single_arg_t {
+        .name = "dict",
+        .short_name = 'D',
+        .value_required = true,
+        .explanation = "Set the preset dictionary the input was compressed with"
+    },
 };
 
 std::atomic < unsigned > thread_count = 1;
 std::atomic < bool > verbose = false;
 std::atomic < uint64_t > processed_size = 0;
+std::atomic < bool > force_unix = false;
+std::atomic < bool > use_preset = false;
+preset::dictionary preset_dictionary;
+std::map < unsigned /* max bits */, lzw_solid_dictionary > primed_dictionaries;
 
 #define BUFFER_HEALTH_CHECK(input, in_buffer) {     \
     if (!(input).good()) {                          \
@@ -95,62 +118,107 @@ bool decompress(std::basic_istream<char>& input, std::basic_ostream<char>& outpu
         return false;
     }
 
-    std::vector < std::pair < uint8_t /* method */, std::vector<uint8_t> > > in_buffers;
+    // a job is a single block, or a solid group whose LZW blocks share one dictionary
+    struct decompression_job {
+        unsigned solid_max_bits = 0; // 0 if the job is not a solid group
+        bool primed = false;         // the group starts from the preset dictionary
+        std::vector < std::pair < uint8_t /* method */, std::vector<uint8_t> > > blocks;
+    };
+
+    std::vector < decompression_job > in_jobs;
     std::vector < std::vector<uint8_t> > out_buffers;
     std::vector < std::thread > threads;
-    in_buffers.resize(thread_count);
+    in_jobs.resize(thread_count);
     out_buffers.resize(thread_count);
 
+    auto read_block = [&](std::pair < uint8_t, std::vector<uint8_t> > & in_buffer)->bool
+    {
+        uint8_t method = 0;
+        input.read(reinterpret_cast<char*>(&method), sizeof(method));
+        if (!input.good()) {
+            return false;
+        }
+
+        uint8_t checksum = 0;
+        input.read(reinterpret_cast<char*>(&checksum), sizeof(checksum));
+        if (!input.good()) {
+            return false;
+        }
+
+        uint16_t block_size = 0;
+        input.read(reinterpret_cast<char*>(&block_size), sizeof(block_size));
+        if (!input.good()) {
+            return false;
+        }
+
+        in_buffer.first = method;
+        in_buffer.second.resize(block_size);
+        input.read(reinterpret_cast<char*>(in_buffer.second.data()), block_size);
+        if (const auto actual_size = input.gcount(); actual_size != block_size) {
+            return false;
+        }
+
+        std::vector<uint8_t> data_pool;
+        data_pool.reserve(block_size + 2);
+        data_pool.push_back(reinterpret_cast<char *>(&block_size)[0]);
+        data_pool.push_back(reinterpret_cast<char *>(&block_size)[1]);
+        data_pool.insert(end(data_pool), begin(in_buffer.second), end(in_buffer.second));
+        if (!pass_for_8bit(data_pool, checksum)) {
+            throw std::runtime_error("File corrupted on block with method " + std::to_string(method));
+        }
+
+        processed_size += in_buffer.second.size() + 3;
+        return true;
+    };
+
     // read in queue
     for (unsigned i = 0; i < thread_count; ++i)
     {
-        auto & in_buffer = in_buffers[i];
+        auto & job = in_jobs[i];
+        std::pair < uint8_t, std::vector<uint8_t> > in_buffer;
+        if (!read_block(in_buffer)) {
+            break;
+        }
 
-        auto read_block = [&]()->bool
-        {
-            uint8_t method = 0;
-            input.read(reinterpret_cast<char*>(&method), sizeof(method));
-            if (!input.good()) {
-                return false;
-            }
+        if (in_buffer.first != used_solid_group) {
+            job.blocks.emplace_back(std::move(in_buffer));
+            continue;
+        }
 
-            uint8_t checksum = 0;
-            input.read(reinterpret_cast<char*>(&checksum), sizeof(checksum));
-            if (!input.good()) {
-                return false;
-            }
+        // [16bit Block Count] [Max Code Width] ([32bit Preset Dictionary ID])
+        if (in_buffer.second.size() != 3 && in_buffer.second.size() != 7) {
+            throw std::runtime_error("Corrupted solid group header");
+        }
 
-            uint16_t block_size = 0;
-            input.read(reinterpret_cast<char*>(&block_size), sizeof(block_size));
-            if (!input.good()) {
-                return false;
+        uint16_t block_count = 0;
+        std::memcpy(&block_count, in_buffer.second.data(), sizeof(block_count));
+        job.solid_max_bits = in_buffer.second[2];
+        job.primed = in_buffer.second.size() == 7;
+        if (job.primed)
+        {
+            uint32_t id = 0;
+            std::memcpy(&id, in_buffer.second.data() + 3, sizeof(id));
+            if (!use_preset || id != preset_dictionary.id) {
+                throw std::runtime_error("Input needs the preset dictionary with ID " + std::to_string(id));
             }
 
-            in_buffer.first = method;
-            in_buffer.second.resize(block_size);
-            input.read(reinterpret_cast<char*>(in_buffer.second.data()), block_size);
-            if (const auto actual_size = input.gcount(); actual_size != block_size) {
-                return false;
+            // priming takes a while, so it is done once per width and copied over to every group
+            if (!primed_dictionaries.contains(job.solid_max_bits)) {
+                primed_dictionaries.emplace(job.solid_max_bits, preset::prime(preset_dictionary, job.solid_max_bits));
             }
+        }
 
-            std::vector<uint8_t> data_pool;
-            data_pool.reserve(block_size + 2);
-            data_pool.push_back(reinterpret_cast<char *>(&block_size)[0]);
-            data_pool.push_back(reinterpret_cast<char *>(&block_size)[1]);
-            data_pool.insert(end(data_pool), begin(in_buffer.second), end(in_buffer.second));
-            if (!pass_for_8bit(data_pool, checksum)) {
-                throw std::runtime_error("File corrupted on block with method " + std::to_string(method));
+        job.blocks.resize(block_count);
+        for (auto & block : job.blocks)
+        {
+            if (!read_block(block)) {
+                throw std::runtime_error("Solid group truncated, corrupted data?");
             }
 
-            return true;
-        };
-
-        if (!read_block()) {
-            in_buffer.second.clear();
-            break;
+            if (block.first == used_solid_group) {
+                throw std::runtime_error("Nested solid group, corrupted data?");
+            }
         }
-
-        processed_size += in_buffer.second.size() + 3;
     }
 
     auto decompress_lzw_block = [](std::vector < uint8_t > * in_buffer,
@@ -160,6 +228,44 @@ bool decompress(std::basic_istream<char>& input, std::basic_ostream<char>& outpu
         decompressor.decompress();
     };
 
+    auto decompress_lzw_variable_block = [](std::vector < uint8_t > * in_buffer,
+        std::vector < uint8_t > * out_buffer)->void
+    {
+        // [Max Code Width] [Codes]
+        if (in_buffer->empty()) {
+            throw std::runtime_error("Corrupted LZW stream");
+        }
+
+        const auto max_bits = in_buffer->front();
+        std::vector < uint8_t > codes(begin(*in_buffer) + 1, end(*in_buffer));
+        lzw_dispatch(max_bits, [&](auto bits)->void
+        {
+            lzw <decltype(bits)::value> decompressor(codes, *out_buffer);
+            decompressor.decompress_variable();
+        });
+    };
+
+    auto decompress_lzw_fixed_block = [](std::vector < uint8_t > * in_buffer,
+        std::vector < uint8_t > * out_buffer, const bool adaptive)->void
+    {
+        // [Code Width] [Codes]
+        if (in_buffer->empty()) {
+            throw std::runtime_error("Corrupted LZW stream");
+        }
+
+        const auto code_width = in_buffer->front();
+        std::vector < uint8_t > codes(begin(*in_buffer) + 1, end(*in_buffer));
+        lzw_dispatch(code_width, [&](auto bits)->void
+        {
+            lzw <decltype(bits)::value> decompressor(codes, *out_buffer);
+            if (adaptive) {
+                decompressor.decompress_adaptive();
+            } else {
+                decompressor.decompress();
+            }
+        });
+    };
+
     auto decompress_huffman_lzw_block = [&](std::vector < uint8_t > * in_buffer,
     std::vector < uint8_t > * out_buffer)->void
     {
@@ -169,6 +275,29 @@ bool decompress(std::basic_istream<char>& input, std::basic_ostream<char>& outpu
         HuffmanDecompressor.decompress();
     };
 
+    auto decompress_huffman_canonical_lzw_block = [&](std::vector < uint8_t > * in_buffer,
+    std::vector < uint8_t > * out_buffer)->void
+    {
+        std::vector < uint8_t > lzw_decompressed;
+        decompress_lzw_block(in_buffer, &lzw_decompressed);
+        Huffman HuffmanDecompressor(lzw_decompressed, *out_buffer);
+        HuffmanDecompressor.decompress_canonical();
+    };
+
+    auto decompress_huffman_pure_block = [](std::vector < uint8_t > * in_buffer,
+    std::vector < uint8_t > * out_buffer)->void
+    {
+        Huffman HuffmanDecompressor(*in_buffer, *out_buffer);
+        HuffmanDecompressor.decompress_canonical();
+    };
+
+    auto decompress_huffman_interleaved_block = [](std::vector < uint8_t > * in_buffer,
+    std::vector < uint8_t > * out_buffer)->void
+    {
+        Huffman HuffmanDecompressor(*in_buffer, *out_buffer);
+        HuffmanDecompressor.decompress_interleaved();
+    };
+
     auto decompress_arithmetic_block = [](std::vector < uint8_t > * in_buffer,
     std::vector < uint8_t > * out_buffer)->void
     {
@@ -184,6 +313,56 @@ bool decompress(std::basic_istream<char>& input, std::basic_ostream<char>& outpu
         decompress_arithmetic_block(&lzw_decompressed, out_buffer);
     };
 
+    auto decompress_arithmetic_range_block = [](std::vector < uint8_t > * in_buffer,
+    std::vector < uint8_t > * out_buffer)->void
+    {
+        arithmetic::RangeDecode decompressor(*in_buffer, *out_buffer);
+        decompressor.decode();
+    };
+
+    auto decompress_arithmetic_range_lzw_block = [&](std::vector < uint8_t > * in_buffer,
+        std::vector < uint8_t > * out_buffer)->void
+    {
+        std::vector < uint8_t > lzw_decompressed;
+        decompress_lzw_block(in_buffer, &lzw_decompressed);
+        decompress_arithmetic_range_block(&lzw_decompressed, out_buffer);
+    };
+
+    auto decompress_arithmetic_static_block = [](std::vector < uint8_t > * in_buffer,
+    std::vector < uint8_t > * out_buffer)->void
+    {
+        arithmetic::StaticDecode decompressor(*in_buffer, *out_buffer);
+        decompressor.decode();
+    };
+
+    auto decompress_arithmetic_binary_block = [](std::vector < uint8_t > * in_buffer,
+    std::vector < uint8_t > * out_buffer)->void
+    {
+        arithmetic::BinaryDecode decompressor(*in_buffer, *out_buffer);
+        decompressor.decode();
+    };
+
+    auto decompress_context_block = [](std::vector < uint8_t > * in_buffer,
+    std::vector < uint8_t > * out_buffer, const int order)->void
+    {
+        arithmetic::ContextDecode decompressor(*in_buffer, *out_buffer, order);
+        decompressor.decode();
+    };
+
+    auto decompress_rans_block = [](std::vector < uint8_t > * in_buffer,
+    std::vector < uint8_t > * out_buffer)->void
+    {
+        rans::rans decompressor(*in_buffer, *out_buffer);
+        decompressor.decode();
+    };
+
+    auto decompress_lz77_block = [](std::vector < uint8_t > * in_buffer,
+    std::vector < uint8_t > * out_buffer)->void
+    {
+        lz77::lz77 decompressor(*in_buffer, *out_buffer);
+        decompressor.decode();
+    };
+
     auto raw_copy_over = [&](std::vector < uint8_t > * in_buffer,
     std::vector < uint8_t > * out_buffer)->void
     {
@@ -205,35 +384,107 @@ bool decompress(std::basic_istream<char>& input, std::basic_ostream<char>& outpu
     std::map < uint8_t, decompress_function_type > decoder_map;
     decoder_map.emplace(used_plain, raw_copy_over);
     decoder_map.emplace(used_huffman, decompress_huffman_lzw_block);
+    decoder_map.emplace(used_huffman_canonical, decompress_huffman_canonical_lzw_block);
+    decoder_map.emplace(used_huffman_interleaved, decompress_huffman_interleaved_block);
+    decoder_map.emplace(used_huffman_pure, decompress_huffman_pure_block);
     decoder_map.emplace(used_lzw, decompress_lzw_block);
     decoder_map.emplace(used_arithmetic, decompress_arithmetic_block);
     decoder_map.emplace(used_arithmetic_lzw, decompress_arithmetic_lzw_block);
+    decoder_map.emplace(used_arithmetic_range, decompress_arithmetic_range_block);
+    decoder_map.emplace(used_arithmetic_range_lzw, decompress_arithmetic_range_lzw_block);
+    decoder_map.emplace(used_arithmetic_static, decompress_arithmetic_static_block);
+    decoder_map.emplace(used_arithmetic_binary, decompress_arithmetic_binary_block);
+    decoder_map.emplace(used_rans, decompress_rans_block);
+    decoder_map.emplace(used_lz77, decompress_lz77_block);
+    decoder_map.emplace(used_arithmetic_order1, [&](std::vector < uint8_t > * in_buffer, std::vector < uint8_t > * out_buffer)->void {
+        decompress_context_block(in_buffer, out_buffer, 1);
+    });
+    decoder_map.emplace(used_arithmetic_order2, [&](std::vector < uint8_t > * in_buffer, std::vector < uint8_t > * out_buffer)->void {
+        decompress_context_block(in_buffer, out_buffer, 2);
+    });
     decoder_map.emplace(used_repeator, decompress_repeator);
+    decoder_map.emplace(used_lzw_variable, decompress_lzw_variable_block);
+    decoder_map.emplace(used_lzw_fixed, [&](std::vector < uint8_t > * in_buffer, std::vector < uint8_t > * out_buffer)->void {
+        decompress_lzw_fixed_block(in_buffer, out_buffer, false);
+    });
+    decoder_map.emplace(used_lzw_adaptive, [&](std::vector < uint8_t > * in_buffer, std::vector < uint8_t > * out_buffer)->void {
+        decompress_lzw_fixed_block(in_buffer, out_buffer, true);
+    });
+
+    auto decompress_lzw_solid_block = [](std::vector < uint8_t > * in_buffer,
+        std::vector < uint8_t > * out_buffer,
+        const unsigned max_bits,
+        lzw_solid_dictionary & dictionary)->void
+    {
+        lzw_dispatch(max_bits, [&](auto bits)->void
+        {
+            lzw <decltype(bits)::value> decompressor(*in_buffer, *out_buffer, dictionary);
+            decompressor.decompress_variable();
+        });
+    };
+
+    // Huffman blocks that record their table in a solid group, or reuse the one recorded last
+    const std::set < uint8_t > huffman_solid_methods = {
+        used_huffman_pure, used_huffman_interleaved, used_huffman_repeat, used_huffman_interleaved_repeat };
+    auto decompress_huffman_solid_block = [](const uint8_t method,
+        std::vector < uint8_t > * in_buffer,
+        std::vector < uint8_t > * out_buffer,
+        huffman_solid_table & table)->void
+    {
+        Huffman HuffmanDecompressor(*in_buffer, *out_buffer, table);
+        if (method == used_huffman_pure) {
+            HuffmanDecompressor.decompress_canonical();
+        } else if (method == used_huffman_interleaved) {
+            HuffmanDecompressor.decompress_interleaved();
+        } else {
+            HuffmanDecompressor.decompress_repeat(method == used_huffman_interleaved_repeat);
+        }
+    };
+
+    auto decompress_job = [&](decompression_job * job, std::vector < uint8_t > * out_buffer)->void
+    {
+        if (job->solid_max_bits == 0)
+        {
+            decoder_map.at(job->blocks.front().first)(&job->blocks.front().second, out_buffer);
+            return;
+        }
+
+        // blocks of a solid group are decoded in order, each solid one continues the dictionary
+        lzw_solid_dictionary dictionary = job->primed ? primed_dictionaries.at(job->solid_max_bits) : lzw_solid_dictionary { };
+        huffman_solid_table huffman_table;
+        for (auto & [method, in_buffer] : job->blocks)
+        {
+            std::vector < uint8_t > block_out;
+            if (method == used_lzw_solid) {
+                decompress_lzw_solid_block(&in_buffer, &block_out, job->solid_max_bits, dictionary);
+            } else if (huffman_solid_methods.contains(method)) {
+                decompress_huffman_solid_block(method, &in_buffer, &block_out, huffman_table);
+            } else {
+                decoder_map.at(method)(&in_buffer, &block_out);
+            }
+
+            out_buffer->insert(end(*out_buffer), begin(block_out), end(block_out));
+        }
+    };
 
     // create workers
     for (unsigned i = 0; i < thread_count; ++i)
     {
-        if (!in_buffers[i].second.empty())
+        auto & job = in_jobs[i];
+        if (job.blocks.empty()) {
+            continue;
+        }
+
+        // check methods before handing the job out, so that unknown ones surface here and not in a worker
+        for (const auto & method : job.blocks | std::views::keys)
         {
-            try {
-                threads.emplace_back(decoder_map.at(in_buffers[i].first), &in_buffers[i].second, &out_buffers[i]);
-            } catch (std::out_of_range&) {
+            if (!decoder_map.contains(method) && !((method == used_lzw_solid || huffman_solid_methods.contains(method))
+                && job.solid_max_bits != 0)) {
                 throw std::runtime_error("Unknown compression method, corrupted data?");
             }
-            // if (in_buffers[i].first == used_lzw) {
-            //     threads.emplace_back(decompress_lzw_block, &in_buffers[i].second, &out_buffers[i]);
-            // } else if (in_buffers[i].first == used_huffman) {
-            //     threads.emplace_back(decompress_huffman_lzw_block, &in_buffers[i].second, &out_buffers[i]);
-            // } else if (in_buffers[i].first == used_arithmetic) {
-            //     threads.emplace_back(decompress_arithmetic_block, &in_buffers[i].second, &out_buffers[i]);
-            // } else if (in_buffers[i].first == used_plain) {
-            //     threads.emplace_back(raw_copy_over, &in_buffers[i].second, &out_buffers[i]);
-            // } else if (in_buffers[i].first == used_arithmetic_lzw) {
-            //     threads.emplace_back(decompress_arithmetic_lzw_block, &in_buffers[i].second, &out_buffers[i]);
-            // } else {
-            //     throw std::runtime_error("Unknown compression method, corrupted data?");
-            // }
         }
+
+        threads.emplace_back(decompress_job, &job, &out_buffers[i]);
     }
 
     // waiting for them to finish
@@ -254,12 +505,60 @@ bool decompress(std::basic_istream<char>& input, std::basic_ostream<char>& outpu
     return true;
 }
 
+// .Z streams share the first two magic bytes, the third one only reads the same as ours for a non-block 9 bit stream
+bool is_unix_stream(const char (&header)[3])
+{
+    return std::memcmp(header, unix_magic, sizeof(unix_magic)) == 0
+        && (force_unix || static_cast<uint8_t>(header[2]) != magic[2]);
+}
+
+// compress(1) stream, one LZW run over the whole input, read in chunks
+void decompress_unix(std::basic_istream<char>& input, std::basic_ostream<char>& output, const uint8_t flags)
+{
+    const unsigned max_bits = flags & unix_bits_mask;
+    if ((flags & unix_reserved_flags) != 0
+        || max_bits < LZW_UNIX_MAX_BIT_SIZE_MIN || max_bits > LZW_VARIABLE_MAX_BIT_SIZE_MAX)
+    {
+        throw std::runtime_error("Unsupported .Z stream with header flags " + std::to_string(flags));
+    }
+
+    lzw_solid_dictionary dictionary;
+    dictionary.block_mode = (flags & unix_block_mode) != 0;
+    std::vector<uint8_t> in_buffer, out_buffer;
+    lzw_dispatch(max_bits, [&](auto bits)->void
+    {
+        bool last_chunk = false;
+        while (!last_chunk)
+        {
+            // whatever the decoder left in the buffer is an incomplete group of codes, the new chunk goes after it
+            const auto kept_size = in_buffer.size();
+            in_buffer.resize(kept_size + LZW_UNIX_CHUNK_SIZE);
+            input.read(reinterpret_cast<char*>(in_buffer.data() + kept_size), LZW_UNIX_CHUNK_SIZE);
+            const auto actual_size = input.gcount();
+            in_buffer.resize(kept_size + actual_size);
+            last_chunk = !input.good();
+            processed_size += actual_size;
+
+            lzw <decltype(bits)::value> decompressor(in_buffer, out_buffer, dictionary);
+            decompressor.decompress_unix(last_chunk);
+            output.write(reinterpret_cast<char*>(out_buffer.data()), static_cast<std::streamsize>(out_buffer.size()));
+            out_buffer.clear();
+        }
+    });
+}
+
 void decompress_from_stdin()
 {
     // Set stdin and stdout to binary mode
     set_binary();
     char magick_buff[3];
     std::cin.read(magick_buff, sizeof(magick_buff));
+    if (is_unix_stream(magick_buff)) {
+        decompress_unix(std::cin, std::cout, magick_buff[2]);
+        std::cout.flush();
+        return;
+    }
+
     if (std::memcmp(magick_buff, magic, sizeof(magick_buff)) != 0) {
         throw std::runtime_error("Decompression failed due to invalid magick number");
     }
@@ -323,6 +622,11 @@ void decompress_file(const std::string& in, const std::string& out)
 
     char magick_buff[3];
     input_file.read(magick_buff, sizeof(magick_buff));
+    if (is_unix_stream(magick_buff)) {
+        decompress_unix(input_file, output_file, magick_buff[2]);
+        return;
+    }
+
     if (std::memcmp(magick_buff, magic, sizeof(magick_buff)) != 0) {
         throw std::runtime_error("Decompression failed due to invalid magick number");
     }
@@ -433,11 +737,17 @@ int main(const int argc, const char** argv)
         }
 
         verbose = static_cast<Arguments::args_t>(args).contains("verbose");
+        force_unix = static_cast<Arguments::args_t>(args).contains("unix");
         if (verbose) {
             debug::set_log_level(debug::L_INFO_FG);
             debug::log(debug::to_stderr, debug::info_log, "Verbose mode enabled\n");
         }
 
+        if (static_cast<Arguments::args_t>(args).contains("dict")) {
+            preset_dictionary = preset::load(static_cast<Arguments::args_t>(args).at("dict").back());
+            use_preset = true;
+        }
+
         if (static_cast<Arguments::args_t>(args).contains("input"))
         {
 			const auto input_file = static_cast<Arguments::args_t>(args).at("input");
@@ -28,14 +28,34 @@
 #include <iostream>
 #include <unordered_map>
 #include <map>
+#include <array>
+
+class bit_reader;
+
+// code lengths of the last table sent in a solid group, later blocks of the group can reuse it
+struct huffman_solid_table {
+    std::array < uint8_t, 256 > lengths { };
+    bool valid = false;
+};
 
 class Huffman {
 public:
     using frequency_map = std::vector < std::pair < uint8_t, uint64_t > >;
 
+    // hard cap on canonical code lengths, so that a length fits in 4 bits
+    static constexpr uint64_t canonical_max_length = 15;
+    static constexpr uint64_t interleaved_streams = 4;
+
+    // below this many bytes the jump header and the padding of three more streams cost more than they save
+    static constexpr uint64_t interleaved_min_size = 1024;
+
+    // a previous table is reused as long as it costs no more than 1/128 over a new one
+    static constexpr uint64_t repeat_table_tolerance = 128;
+
 private:
     std::vector < uint8_t > & input_data_;
     std::vector < uint8_t > & output_data_;
+    huffman_solid_table * solid_table_ = nullptr;
 
     struct Node
     {
@@ -54,24 +74,47 @@ private:
         bool am_i_selected = false;
     };
 
+    // code bits right-aligned, emitted MSB first
+    struct huffman_code {
+        uint32_t bits = 0;
+        uint8_t length = 0;
+    };
+
     using full_map_t = std::vector < single_mixed_node >;
     full_map_t full_map;
-    std::map < uint8_t, std::string, std::less<> > encoded_pairs;
-    std::string raw_dump;
+    std::array < huffman_code, 256 > code_table { };
+
+    // indexed by the next decode_table_bits bits of the stream
+    struct decode_entry {
+        uint8_t symbol = 0;
+        uint8_t length = 0;
+    };
+
+    std::vector < decode_entry > decode_table;
+    uint64_t decode_table_bits = 0;
     frequency_map frequency_map_;
 
     void count_data_frequencies();
     void build_binary_tree_based_on_the_frequency_map();
     void walk_through_tree();
-    void walk_to_next_node(uint64_t, const Node &, const std::string &);
-    void encode_using_constructed_pairs();
-    [[nodiscard]] std::vector < uint8_t > convert_std_string_to_std_vector_from_raw_dump(uint64_t &) const;
-    [[nodiscard]] static uint8_t std_string_to_uint8_t(const std::string &);
-    [[nodiscard]] static std::string uint8_t_to_std_string(uint8_t);
+    void walk_to_next_node(uint64_t, const Node &, uint32_t);
+    [[nodiscard]] std::vector < uint8_t > encode_using_code_table(uint64_t &) const;
     [[nodiscard]] std::vector < uint8_t > export_table();
     void import_table(const std::vector < uint8_t > &);
-    void convert_input_to_raw_dump(uint64_t bits);
-    void decode_using_constructed_pairs();
+    static void left_align_tail(std::vector < uint8_t > &, uint64_t);
+    void build_decode_table();
+    void decode_using_decode_table(uint64_t);
+    void build_length_limited_code_lengths(const std::array < uint64_t, 256 > &);
+    void assign_canonical_codes();
+    [[nodiscard]] std::array < uint64_t, 256 > count_symbol_frequencies() const;
+    [[nodiscard]] static uint64_t canonical_table_size(const std::array < uint64_t, 256 > &);
+    void export_canonical_table();
+    void import_canonical_table(uint64_t &);
+    void save_solid_table() const;
+    void load_solid_table();
+    void encode_streams(uint64_t);
+    void decode_streams(uint64_t, uint64_t);
+    [[nodiscard]] uint8_t decode_symbol(bit_reader &) const;
 
 public:
     Huffman(
@@ -83,6 +126,15 @@ public:
         }
     }
 
+    // blocks of a solid group, canonical tables are recorded in solid_table and may be reused
+    Huffman(
+        std::vector < uint8_t > & input_data,
+        std::vector < uint8_t > & output_data,
+        huffman_solid_table & solid_table)
+    : Huffman(input_data, output_data) {
+        solid_table_ = &solid_table;
+    }
+
     ~Huffman() = default;
     Huffman & operator=(const Huffman &) = delete;
     Huffman(const Huffman &) = delete;
@@ -92,6 +144,19 @@ public:
 
     void compress();
     void decompress();
+
+    // optimal codes no longer than canonical_max_length bits, only their lengths are stored
+    void compress_canonical();
+    void decompress_canonical();
+
+    // canonical codes split into four streams, one per quarter of the input, decoded side by side
+    void compress_interleaved();
+    void decompress_interleaved();
+
+    // reuse the table of the solid group if it costs about as much as a new one, true if it was reused,
+    // the block is written with one stream or four, either way without a table
+    [[nodiscard]] bool compress_solid(bool interleaved);
+    void decompress_repeat(bool interleaved);
 };
 
 #endif //HUFFMAN_H
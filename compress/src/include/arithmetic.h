@@ -24,6 +24,7 @@
 #include <vector>
 #include <cstdio>
 #include <cstdint>
+#include <stdexcept>
 
 namespace arithmetic
 {
@@ -39,16 +40,29 @@ namespace arithmetic
     constexpr int EOF_SYMBOL = (NO_OF_CHARS + 1);
     constexpr int NO_OF_SYMBOLS = (NO_OF_CHARS + 1);
 
+    // adaptive model, symbol indexes are kept sorted by decreasing frequency,
+    // cumulative frequencies come out of a Fenwick tree over freq in O(log n)
     class Compress
     {
+        int tree [NO_OF_SYMBOLS + 2]{}; // 1-based, tree[i + 1] covers freq[i]
+
+        void build_tree();
+        [[nodiscard]] int prefix(int index) const; // freq[0] + ... + freq[index]
+
     public:
         unsigned char index_to_char [NO_OF_SYMBOLS + 1]{};
         int char_to_index [NO_OF_CHARS]{};
-        int cum_freq [NO_OF_SYMBOLS + 1]{};
         int freq [NO_OF_SYMBOLS + 1]{};
 
         Compress();
         void update_tables(int sym_index);
+
+        // freq[index + 1] + ... + freq[NO_OF_SYMBOLS], what cum_freq[index] used to hold
+        [[nodiscard]] int cum_freq(int index) const;
+        [[nodiscard]] int total() const { return cum_freq(0); }
+
+        // the first symbol index whose cum_freq is no more than cum
+        [[nodiscard]] int find_symbol(int cum) const;
     };
 
     class Encode : public Compress
@@ -118,6 +132,143 @@ namespace arithmetic
 
         return result;
     }
+
+    // range coder, a 32-bit range renormalized a byte at a time,
+    // with carries out of the 64-bit low kept back in a cached byte and a run of 0xFF bytes after it
+    constexpr uint32_t RANGE_TOP = 1u << 24;
+    constexpr uint64_t RANGE_TRAILING_ZEROS_MAX = 4; // zero bytes the encoder may leave out at the end
+    // the encoder also keeps back its last cached byte, reading further than this means the stream is corrupted
+    constexpr uint64_t RANGE_PAST_END_MAX = RANGE_TRAILING_ZEROS_MAX + 1;
+
+    // probability of a 0 bit, out of 2^BIT_PROBABILITY_BITS
+    constexpr uint32_t BIT_PROBABILITY_BITS = 12;
+    constexpr uint16_t BIT_PROBABILITY_HALF = 1u << (BIT_PROBABILITY_BITS - 1);
+    constexpr uint32_t BIT_ADAPT_SHIFT = 4; // moves 1/16 of the way towards the bit seen
+
+    class range_encoder
+    {
+        uint64_t low = 0;
+        uint32_t range = UINT32_MAX;
+        uint8_t cache = 0;
+        uint64_t pending_bytes = 1; // the cached byte and the 0xFF bytes behind it
+        bool first_byte = true; // the first byte out of the cache is always 0 and left out
+
+        std::vector<uint8_t> & out;
+        const uint64_t out_begin; // where the coded bytes start, anything before belongs to the caller
+
+        void shift_low();
+
+    public:
+        explicit range_encoder(std::vector<uint8_t> & out_) : out(out_), out_begin(out_.size()) { }
+
+        // code [start, start + size) out of total, total has to stay below 2^16
+        void encode(uint32_t start, uint32_t size, uint32_t total);
+        void encode_scaled(uint32_t start, uint32_t size, uint32_t total_bits); // total is 2^total_bits
+        void encode_bit(uint16_t & probability, int bit); // probability is updated after the bit
+        void flush();
+    };
+
+    class range_decoder
+    {
+        uint32_t range = UINT32_MAX;
+        uint32_t code = 0;
+        uint64_t position = 0;
+
+        const std::vector<uint8_t> & in;
+
+        [[nodiscard]] uint8_t get(); // 0 past the end, up to RANGE_PAST_END_MAX bytes
+
+    public:
+        explicit range_decoder(const std::vector<uint8_t> & in_);
+
+        // where the next symbol falls within [0, total), followed by decode() on the interval it belongs to
+        [[nodiscard]] uint32_t target(uint32_t total);
+        [[nodiscard]] uint32_t target_scaled(uint32_t total_bits);
+        [[nodiscard]] int decode_bit(uint16_t & probability);
+        void decode(uint32_t start, uint32_t size);
+    };
+
+    inline uint8_t range_decoder::get()
+    {
+        if (position < in.size()) {
+            return in[position++];
+        }
+
+        if (++position - in.size() > RANGE_PAST_END_MAX) {
+            throw std::runtime_error("Corrupted range coded stream");
+        }
+
+        return 0;
+    }
+
+    // range coder on the same adaptive model
+    class RangeEncode : public Compress
+    {
+        std::vector<uint8_t> & in;
+        range_encoder encoder;
+
+        void encode_symbol(int symbol);
+
+    public:
+        RangeEncode(std::vector<uint8_t> & in_, std::vector<uint8_t> & out_) : in(in_), encoder(out_) { }
+        void encode();
+    };
+
+    class RangeDecode : public Compress
+    {
+        std::vector<uint8_t> & in;
+        std::vector<uint8_t> & out;
+
+        int decode_symbol(range_decoder & decoder);
+
+    public:
+        RangeDecode(std::vector<uint8_t> & in_, std::vector<uint8_t> & out_) : in(in_), out(out_) { }
+        void decode();
+    };
+
+    // semi-static model, the histogram of a block is normalized and sent in front of it,
+    // so that nothing is updated while coding and the decoder finds a symbol with one table lookup
+    class StaticEncode
+    {
+        std::vector<uint8_t> & in;
+        std::vector<uint8_t> & out;
+
+    public:
+        StaticEncode(std::vector<uint8_t> & in_, std::vector<uint8_t> & out_) : in(in_), out(out_) { }
+        void encode();
+    };
+
+    class StaticDecode
+    {
+        std::vector<uint8_t> & in;
+        std::vector<uint8_t> & out;
+
+    public:
+        StaticDecode(std::vector<uint8_t> & in_, std::vector<uint8_t> & out_) : in(in_), out(out_) { }
+        void decode();
+    };
+
+    // binary adaptive model, a byte is 8 decisions down a 255-node tree, MSB first,
+    // each node keeps its own probability so no cumulative frequencies are involved
+    class BinaryEncode
+    {
+        std::vector<uint8_t> & in;
+        std::vector<uint8_t> & out;
+
+    public:
+        BinaryEncode(std::vector<uint8_t> & in_, std::vector<uint8_t> & out_) : in(in_), out(out_) { }
+        void encode();
+    };
+
+    class BinaryDecode
+    {
+        std::vector<uint8_t> & in;
+        std::vector<uint8_t> & out;
+
+    public:
+        BinaryDecode(std::vector<uint8_t> & in_, std::vector<uint8_t> & out_) : in(in_), out(out_) { }
+        void decode();
+    };
 }
 
 #endif //ARITHMETIC_H
@@ -0,0 +1,136 @@
+/* bitstream.h
+ *
+ * Copyright 2025 Anivice Ives
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef BITSTREAM_H
+#define BITSTREAM_H
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// MSB first bit writer, a trailing partial byte is padded with 0 bits
+class bit_writer {
+    std::vector < uint8_t > & output_;
+    uint64_t accumulator_ = 0;
+    uint64_t accumulated_bits_ = 0;
+    uint64_t written_bits_ = 0;
+
+public:
+    explicit bit_writer(std::vector < uint8_t > & output) : output_(output) { }
+
+    // at most 32 bits at a time
+    void write(const uint64_t bits, const uint64_t length)
+    {
+        accumulator_ = accumulator_ << length | bits;
+        accumulated_bits_ += length;
+        written_bits_ += length;
+        if (accumulated_bits_ >= 32)
+        {
+            accumulated_bits_ -= 32;
+            const auto word = static_cast<uint32_t>(accumulator_ >> accumulated_bits_);
+            const uint8_t bytes[] = {
+                static_cast<uint8_t>(word >> 24), static_cast<uint8_t>(word >> 16),
+                static_cast<uint8_t>(word >> 8), static_cast<uint8_t>(word) };
+            output_.insert(output_.end(), bytes, bytes + sizeof(bytes));
+        }
+    }
+
+    // write out what is left and return the number of bits written,
+    // the legacy Huffman layout keeps the bits of a trailing partial byte right-aligned instead
+    uint64_t flush(const bool right_aligned_tail = false)
+    {
+        while (accumulated_bits_ >= 8)
+        {
+            accumulated_bits_ -= 8;
+            output_.push_back(static_cast<uint8_t>(accumulator_ >> accumulated_bits_));
+        }
+
+        if (accumulated_bits_ != 0)
+        {
+            const auto tail = static_cast<uint8_t>(accumulator_ & ((1ull << accumulated_bits_) - 1));
+            output_.push_back(right_aligned_tail ? tail : static_cast<uint8_t>(tail << (8 - accumulated_bits_)));
+        }
+
+        accumulated_bits_ = 0;
+        return written_bits_;
+    }
+};
+
+// MSB first bit reader, zeros are read past the end so that peeking near it is safe
+class bit_reader {
+    const uint8_t * data_;
+    uint64_t size_;
+    uint64_t position_ = 0;
+    uint64_t accumulator_ = 0;
+    uint64_t accumulated_bits_ = 0;
+
+    // keep at least 57 bits in the accumulator
+    void refill()
+    {
+        if (position_ + sizeof(uint64_t) <= size_)
+        {
+            uint64_t word = 0;
+            std::memcpy(&word, data_ + position_, sizeof(word));
+            if constexpr (std::endian::native == std::endian::little) {
+                word = std::byteswap(word);
+            }
+
+            const uint64_t bytes = (63 - accumulated_bits_) / 8;
+            accumulator_ = accumulator_ << bytes * 8 | word >> (64 - bytes * 8);
+            accumulated_bits_ += bytes * 8;
+            position_ += bytes;
+            return;
+        }
+
+        while (accumulated_bits_ <= 56)
+        {
+            accumulator_ = accumulator_ << 8 | (position_ < size_ ? data_[position_] : 0);
+            accumulated_bits_ += 8;
+            position_++;
+        }
+    }
+
+public:
+    explicit bit_reader(const std::vector < uint8_t > & input) : data_(input.data()), size_(input.size()) { }
+
+    // at most 32 bits at a time
+    [[nodiscard]] uint64_t peek(const uint64_t length)
+    {
+        if (accumulated_bits_ < length) {
+            refill();
+        }
+
+        return (accumulator_ >> (accumulated_bits_ - length)) & ((1ull << length) - 1);
+    }
+
+    void skip(const uint64_t length) {
+        accumulated_bits_ -= length;
+    }
+
+    [[nodiscard]] uint64_t read(const uint64_t length)
+    {
+        const auto bits = peek(length);
+        skip(length);
+        return bits;
+    }
+};
+
+#endif //BITSTREAM_H
@@ -0,0 +1,96 @@
+/* context.h
+ *
+ * Copyright 2025 Anivice Ives
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef CONTEXT_H
+#define CONTEXT_H
+
+#include "arithmetic.h"
+#include <vector>
+#include <cstdint>
+
+// order-1 and hashed order-2 context models on the range coder,
+// a symbol not seen in a context yet is escaped down to the next shorter one, and finally to the order-0 model
+namespace arithmetic
+{
+    constexpr uint32_t CONTEXT_ORDER2_HASH_BITS = 14;
+    constexpr uint32_t CONTEXT_MAX_COUNT = 8192; // counts are halved past this
+    constexpr uint16_t CONTEXT_INCREMENT = 2;
+
+    // only the symbols seen so far are kept, the escape takes one slot for each of them
+    struct context_symbol
+    {
+        uint8_t symbol;
+        uint16_t count;
+    };
+
+    struct context_entry
+    {
+        std::vector<context_symbol> symbols;
+        uint32_t count_sum = 0;
+
+        [[nodiscard]] uint32_t total() const { return count_sum + static_cast<uint32_t>(symbols.size()); }
+        void add(uint8_t symbol);
+        void increment(uint64_t index);
+    };
+
+    class ContextModel : public Compress // the order-0 model at the bottom
+    {
+    protected:
+        const int order;
+        std::vector<int32_t> order1_slots; // previous byte -> context, -1 if not seen yet
+        std::vector<int32_t> order2_slots; // hash of the previous two bytes -> context
+        std::vector<context_entry> contexts;
+        uint8_t previous1 = 0;
+        uint8_t previous2 = 0;
+
+        // contexts to go through, longest first, a slot is -1 if its context is not there yet
+        [[nodiscard]] int levels(int32_t ** slots);
+
+        // put the symbol into every context it was escaped from, and move on to the next position
+        void update(int32_t ** slots, int found_level, int level_count, uint8_t symbol);
+
+    public:
+        explicit ContextModel(int order_);
+    };
+
+    class ContextEncode : public ContextModel
+    {
+        std::vector<uint8_t> & in;
+        range_encoder encoder;
+
+    public:
+        ContextEncode(std::vector<uint8_t> & in_, std::vector<uint8_t> & out_, const int order_)
+            : ContextModel(order_), in(in_), encoder(out_) { }
+        void encode();
+    };
+
+    class ContextDecode : public ContextModel
+    {
+        std::vector<uint8_t> & in;
+        std::vector<uint8_t> & out;
+
+    public:
+        ContextDecode(std::vector<uint8_t> & in_, std::vector<uint8_t> & out_, const int order_)
+            : ContextModel(order_), in(in_), out(out_) { }
+        void decode();
+    };
+}
+
+#endif //CONTEXT_H
@@ -0,0 +1,51 @@
+/* lz77.h
+ *
+ * Copyright 2025 Anivice Ives
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef LZ77_H
+#define LZ77_H
+
+#include <vector>
+#include <cstdint>
+
+// byte aligned LZ77 in the manner of LZ4, built for speed over ratio,
+// matches are found through a hash table of the last position seen for every 4-byte prefix
+namespace lz77 {
+    constexpr uint64_t min_match = 4;
+    constexpr uint64_t max_offset = 65535;
+    constexpr uint32_t hash_bits = 13;
+    constexpr uint32_t skip_shift = 5; // after 32 literals without a match, step 2 bytes at a time, and so on
+    constexpr uint64_t wild_copy_padding = 16; // the decoder may write this far past the end of a match
+
+class lz77 {
+private:
+    std::vector < uint8_t > & input_;
+    std::vector < uint8_t > & output_;
+
+public:
+    lz77(std::vector<uint8_t> & input, std::vector<uint8_t> & output)
+        : input_(input), output_(output) {}
+
+    void encode();
+    void decode();
+};
+
+}
+
+#endif //LZ77_H
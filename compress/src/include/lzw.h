@@ -22,7 +22,71 @@
 #define LZW_H
 
 #include "numeric.h"
-#include <unordered_map>
+#include <type_traits>
+
+// code 256 resets the dictionary in variable width streams, the first composed string takes 257
+constexpr uint32_t LZW_CLEAR_CODE = 256;
+constexpr uint32_t LZW_FIRST_CODE = 257;
+constexpr unsigned LZW_INITIAL_BIT_SIZE = 9;
+
+// compress(1) checks its compression ratio every this many input bytes once the dictionary is full
+constexpr uint64_t LZW_UNIX_CHECK_GAP = 10000;
+
+// an adaptive stream compares each window of input bytes per emitted code against the best window since the
+// last reset, and resets the full dictionary once it falls under NUMERATOR/DENOMINATOR of it
+constexpr uint64_t LZW_ADAPTIVE_WINDOW = 1024;
+constexpr uint64_t LZW_ADAPTIVE_THRESHOLD_NUMERATOR = 7;
+constexpr uint64_t LZW_ADAPTIVE_THRESHOLD_DENOMINATOR = 8;
+
+// preset strings take at most NUMERATOR/DENOMINATOR of a primed dictionary, the rest is left to the data
+constexpr uint64_t LZW_PRIME_LIMIT_NUMERATOR = 3;
+constexpr uint64_t LZW_PRIME_LIMIT_DENOMINATOR = 4;
+
+// how codes are laid out in the stream
+enum class lzw_layout {
+    fixed,          // LzwCompressionBitSize wide codes
+    adaptive,       // fixed, the never emitted code DictionarySize resets the dictionary once it stops paying off
+    variable,       // 9 bits wide up to LzwCompressionBitSize, LZW_CLEAR_CODE once the dictionary is full
+    unix_compress,  // variable, packed in groups of 8 codes as compress(1) does
+};
+
+// dictionaries of an lzw instance, kept apart from it so that a solid stream can carry them over to the next block
+template < typename CodeType >
+struct lzw_dictionary
+{
+    // encoder dictionary, an open addressing table keyed on (prefix code, next byte)
+    struct slot {
+        uint32_t key = 0;   // ((prefix code << 8) | next byte) + 1, 0 marks an empty slot
+        uint32_t code = 0;
+    };
+
+    unsigned bits = 0;
+    uint32_t mask = 0;
+    std::vector < slot > slots;
+
+    // decoder dictionary, every string is its prefix code plus one last byte
+    std::vector < CodeType > prefix;
+    std::vector < uint8_t > suffix;
+    std::vector < CodeType > length;
+
+    // code the next composed string takes, and the current code width
+    uint32_t next_code = 0;
+    unsigned code_bits = 0;
+
+    // a compress(1) stream spans many calls, this is what is in flight between two of them
+    uint32_t pending_code = UINT32_MAX; // string the encoder is still matching, or code the decoder read last
+    unsigned group_codes = 0;           // codes the encoder has put into the current group of 8
+    uint64_t carried = 0;               // encoder output short of a whole byte
+    unsigned carried_bits = 0;
+    uint64_t bytes_in = 0;              // encoder ratio check
+    uint64_t bytes_out = 0;
+    uint64_t checkpoint = 0;
+    uint64_t best_ratio = 0;
+    bool block_mode = true;             // decoder, false for the old streams without LZW_CLEAR_CODE
+};
+
+// every width lzw_dispatch reaches shares this one
+using lzw_solid_dictionary = lzw_dictionary < uint16_t >;
 
 template < 
     unsigned LzwCompressionBitSize,
@@ -32,14 +96,33 @@ class lzw
 {
 	std::vector < uint8_t > & input_stream_;
     std::vector < uint8_t > & output_stream_;
-	std::unordered_map < std::string, bitwise_numeric < LzwCompressionBitSize > > dictionary_;
+
+public:
+    using code_type = std::conditional_t < (LzwCompressionBitSize <= 16), uint16_t, uint32_t >;
+    using dictionary_type = lzw_dictionary < code_type >;
+
+private:
+    dictionary_type own_dictionary_;
+    dictionary_type & dictionary_;
+    const bool solid_ = false;
     bool discarding_this_instance = false;
 
+    void reset_dictionary(uint64_t max_entries);
+    [[nodiscard]] uint32_t dictionary_probe(uint32_t key) const;
+    template < lzw_layout Layout > void encode(bool last_chunk = true);
+    template < lzw_layout Layout > void decode(bool last_chunk = true);
+
 public:
     explicit lzw(
         std::vector < uint8_t >& input_stream,
         std::vector < uint8_t >& output_stream);
 
+    // solid instance, variable width codes continue with the dictionary the previous block left behind
+    explicit lzw(
+        std::vector < uint8_t >& input_stream,
+        std::vector < uint8_t >& output_stream,
+        dictionary_type & solid_dictionary);
+
 	// forbid any copy/move constructor or assignment
 	lzw(const lzw&) = delete;
 	lzw(lzw&&) = delete;
@@ -49,11 +132,45 @@ public:
 	// destructor
 	~lzw() = default;
 
-    // basic operations
+    // basic operations, fixed LzwCompressionBitSize wide codes
 	void compress();
 	void decompress();
+
+    // fixed width codes, a full dictionary is reset as soon as the compression ratio degrades
+    void compress_adaptive();
+    void decompress_adaptive();
+
+    // codes start 9 bits wide and grow up to LzwCompressionBitSize, a full dictionary is reset by LZW_CLEAR_CODE.
+    // a solid instance only starts from scratch if its dictionary is still empty
+    void compress_variable();
+    void decompress_variable();
+
+    // compress(1) .Z stream, fed chunk by chunk to solid instances sharing one dictionary, the 3 byte header
+    // is left to the caller. the encoder holds the string it is matching back until the last chunk, the decoder
+    // leaves a trailing incomplete group of codes in the input for the next call
+    void compress_unix(bool last_chunk);
+    void decompress_unix(bool last_chunk);
+
+    // fill the still empty dictionary of a solid instance with every suffix of the preset strings, for both
+    // directions, so that variable width blocks coded with it start out knowing them. the streams are not touched
+    void prime(const std::vector < std::vector < uint8_t > > & strings);
 };
 
+// call function with std::integral_constant < unsigned, bits >, so that a code width
+// chosen at runtime still lands on a compile-time specialized lzw instance
+template < typename Function >
+decltype(auto) lzw_dispatch(unsigned bits, Function && function);
+
+// instantiated in lzw.cpp
+extern template class lzw < 9 >;
+extern template class lzw < 10 >;
+extern template class lzw < 11 >;
+extern template class lzw < 12 >;
+extern template class lzw < 13 >;
+extern template class lzw < 14 >;
+extern template class lzw < 15 >;
+extern template class lzw < 16 >;
+
 #endif //LZW_H
 
 // inline definition for lzw utilities
@@ -24,6 +24,8 @@
 #include <iostream>
 #include <algorithm>
 #include <cstring>
+#include <string>
+#include <stdexcept>
 #include "lzw.h"
 
 template < unsigned LzwCompressionBitSize, unsigned DictionarySize >
@@ -32,93 +34,300 @@ lzw<LzwCompressionBitSize, DictionarySize>::lzw(
     std::vector < uint8_t >& input_stream,
     std::vector < uint8_t >& output_stream)
 : input_stream_(input_stream),
-  output_stream_(output_stream)
+  output_stream_(output_stream),
+  dictionary_(own_dictionary_)
 {
-    // Initialize the dictionary
-    for (int i = 0; i < 256; ++i) {
-        dictionary_.emplace(std::string(1, static_cast<char>(i)),
-            bitwise_numeric<LzwCompressionBitSize>::make_bitwise_numeric_loosely(i));
+}
+
+template < unsigned LzwCompressionBitSize, unsigned DictionarySize >
+    requires (LzwCompressionBitSize > 8)
+lzw<LzwCompressionBitSize, DictionarySize>::lzw(
+    std::vector < uint8_t >& input_stream,
+    std::vector < uint8_t >& output_stream,
+    dictionary_type & solid_dictionary)
+: input_stream_(input_stream),
+  output_stream_(output_stream),
+  dictionary_(solid_dictionary),
+  solid_(true)
+{
+}
+
+template < unsigned LzwCompressionBitSize, unsigned DictionarySize >
+    requires (LzwCompressionBitSize > 8)
+void lzw<LzwCompressionBitSize, DictionarySize>::reset_dictionary(const uint64_t max_entries)
+{
+    // keep the load factor under 1/2, single byte strings are implicit (code == byte)
+    dictionary_.bits = 8;
+    while (two_power<uint64_t>(dictionary_.bits) < max_entries * 2) {
+        dictionary_.bits++;
     }
+
+    dictionary_.mask = two_power<uint32_t>(dictionary_.bits) - 1;
+    dictionary_.slots.assign(two_power<uint64_t>(dictionary_.bits), typename dictionary_type::slot { });
 }
 
 template < unsigned LzwCompressionBitSize, unsigned DictionarySize >
     requires (LzwCompressionBitSize > 8)
-void lzw<LzwCompressionBitSize, DictionarySize>::compress()
+uint32_t lzw<LzwCompressionBitSize, DictionarySize>::dictionary_probe(const uint32_t key) const
+{
+    // Fibonacci hashing, top bits of the product are the best mixed ones
+    const auto * slots = dictionary_.slots.data();
+    uint32_t slot = (key * 0x9E3779B1u) >> (32 - dictionary_.bits);
+    while (slots[slot].key != 0 && slots[slot].key != key) {
+        slot = (slot + 1) & dictionary_.mask;
+    }
+
+    // either the slot holding key, or the empty slot key would be inserted into
+    return slot;
+}
+
+template < unsigned LzwCompressionBitSize, unsigned DictionarySize >
+    requires (LzwCompressionBitSize > 8)
+template < lzw_layout Layout >
+void lzw<LzwCompressionBitSize, DictionarySize>::encode(const bool last_chunk)
 {
+    constexpr bool VariableWidth = Layout == lzw_layout::variable || Layout == lzw_layout::unix_compress;
+    constexpr bool UnixCompress = Layout == lzw_layout::unix_compress;
+    constexpr bool Adaptive = Layout == lzw_layout::adaptive;
+    constexpr uint32_t no_code = UINT32_MAX;
+
+    // compress(1) moves on from 9 bit codes at 512 entries even if 9 bits is the maximum, they end up 10 bits wide
+    constexpr unsigned widest_bits = UnixCompress && LzwCompressionBitSize == LZW_INITIAL_BIT_SIZE ?
+        LZW_INITIAL_BIT_SIZE + 1 : LzwCompressionBitSize;
+
     if (discarding_this_instance)
     {
 		throw std::invalid_argument("This instance has been discarded");
     }
 
-    if (input_stream_.empty())
+    // the last chunk of a compress(1) stream may bring nothing but the end of the string being matched
+    if (input_stream_.empty() && (!UnixCompress || !last_chunk))
     {
 	    return;
     }
 
-    std::string current_string {};
+    if (!VariableWidth && solid_)
+    {
+        throw std::invalid_argument("Solid LZW instances only support variable width codes");
+    }
+
+    if (UnixCompress && !solid_)
+    {
+        throw std::invalid_argument("compress(1) streams need a dictionary shared by all of their chunks");
+    }
+
+    constexpr uint32_t code_limit = VariableWidth ? two_power(LzwCompressionBitSize) : DictionarySize;
+    const uint32_t first_code = VariableWidth ? LZW_FIRST_CODE : 256;
+    if (!solid_ || dictionary_.slots.empty())
+    {
+        // a dictionary never holds more composed strings than there are input bytes,
+        // unless it is carried over to the blocks after this one
+        reset_dictionary(solid_ ? code_limit - first_code
+            : std::min<uint64_t>(code_limit - first_code, input_stream_.size()));
+        dictionary_.next_code = first_code;
+        dictionary_.code_bits = VariableWidth ? LZW_INITIAL_BIT_SIZE : LzwCompressionBitSize;
+        dictionary_.bytes_out = 3; // compress(1) counts its header in
+        dictionary_.checkpoint = LZW_UNIX_CHECK_GAP;
+    }
+
+    auto * const slots = dictionary_.slots.data();
     bitwise_numeric_stack < LzwCompressionBitSize > result_stack;
-    bitwise_numeric<LzwCompressionBitSize> next_code = 
-        bitwise_numeric < LzwCompressionBitSize>::make_bitwise_numeric_loosely(256);
+    bitwise_writer writer(output_stream_, dictionary_.carried, dictionary_.carried_bits);
+    unsigned code_bits = dictionary_.code_bits;
+    uint32_t next_code = dictionary_.next_code;
+    unsigned group_codes = dictionary_.group_codes;
+    const uint64_t output_start = output_stream_.size();
+    uint64_t window_start = 0, window_codes = 0, best_window = 0;
+
+    // compress(1) writes codes in groups of 8, a group cut short by a width change or a reset is padded out
+    auto end_group = [&]()->void
+    {
+        if constexpr (UnixCompress)
+        {
+            for (; group_codes != 0 && group_codes < 8; group_codes++) {
+                writer.write(0, code_bits);
+            }
 
-    // Compression process
-    std::ranges::reverse(input_stream_);
-    while (!input_stream_.empty()) 
+            group_codes = 0;
+        }
+    };
+
+    auto emit = [&](const uint32_t code)->void
+    {
+        if constexpr (VariableWidth)
+        {
+            writer.write(code, code_bits);
+            if constexpr (UnixCompress) {
+                group_codes = (group_codes + 1) % 8;
+            }
+
+            // widen the codes once the entry the decoder adds next no longer fits in
+            if (next_code > two_power<uint32_t>(code_bits) - 1 && code_bits < widest_bits) {
+                end_group();
+                code_bits++;
+            }
+        } else {
+            result_stack.push(bitwise_numeric<LzwCompressionBitSize>::make_bitwise_numeric_loosely(code));
+            window_codes++;
+        }
+    };
+
+    // start over with an empty dictionary
+    auto clear = [&]()->void
+    {
+        if constexpr (VariableWidth) {
+            writer.write(LZW_CLEAR_CODE, code_bits);
+        } else {
+            result_stack.push(bitwise_numeric<LzwCompressionBitSize>::make_bitwise_numeric_loosely(DictionarySize));
+        }
+
+        if constexpr (UnixCompress) {
+            group_codes = (group_codes + 1) % 8;
+            end_group();
+        }
+
+        std::ranges::fill(dictionary_.slots, typename dictionary_type::slot { });
+        next_code = first_code;
+        code_bits = VariableWidth ? LZW_INITIAL_BIT_SIZE : LzwCompressionBitSize;
+    };
+
+    // Compression process, current_code is the code of the current string
+    uint64_t i = 0;
+    uint32_t current_code = dictionary_.pending_code;
+    if (current_code == no_code && !input_stream_.empty()) {
+        current_code = input_stream_[i++];
+    }
+
+    for (; i < input_stream_.size(); ++i)
     {
         // Get input symbol while there are input symbols left
-        const auto c = static_cast<char>(input_stream_.back());
-        input_stream_.pop_back();
-        if (const auto combined_string = current_string + c;
-            dictionary_.contains(combined_string)) // combined_string is in the table
+        const uint8_t c = input_stream_[i];
+        const uint32_t key = ((current_code << 8) | c) + 1;
+        const uint32_t slot = dictionary_probe(key);
+        if (slots[slot].key == key) // combined string is in the table
         {
             // update current string
-            current_string = combined_string;
+            current_code = slots[slot].code;
+            continue;
         }
-        else
+
+        // Output the code for current string
+        emit(current_code);
+        // Add combined string to the dictionary, slot is the empty one the probe stopped on
+        if (next_code < code_limit)
         {
-			// Output the code for current string
-			result_stack.push(dictionary_.at(current_string));
-			// Add combined_string to the dictionary
-			if (next_code < next_code.make_bitwise_numeric(DictionarySize)) {
-				dictionary_.emplace(combined_string, next_code);
-                ++next_code;
-			}
+            slots[slot].key = key;
+            slots[slot].code = next_code++;
 
-			// Update current string to the new character
-			current_string = std::string(1, c);
+            // windows are only measured on a full table, the codes while it fills don't count
+            if constexpr (Adaptive)
+            {
+                if (next_code == code_limit) {
+                    window_start = i;
+                    window_codes = 0;
+                }
+            }
         }
-    }
+        else if constexpr (UnixCompress)
+        {
+            // a full dictionary is kept as long as the compression ratio keeps up, checked every LZW_UNIX_CHECK_GAP bytes
+            if (const uint64_t bytes_in = dictionary_.bytes_in + i;
+                bytes_in >= dictionary_.checkpoint)
+            {
+                const uint64_t bytes_out = dictionary_.bytes_out + output_stream_.size() - output_start;
+                const uint64_t ratio = (bytes_in << 8) / std::max<uint64_t>(bytes_out, 1);
+                dictionary_.checkpoint = bytes_in + LZW_UNIX_CHECK_GAP;
+                if (ratio > dictionary_.best_ratio) {
+                    dictionary_.best_ratio = ratio;
+                } else {
+                    dictionary_.best_ratio = 0;
+                    clear();
+                }
+            }
+        }
+        else if constexpr (Adaptive)
+        {
+            // codes are all the same width, so input bytes per code tells how well the frozen dictionary still does
+            if (i - window_start >= LZW_ADAPTIVE_WINDOW)
+            {
+                const uint64_t ratio = ((i - window_start) << 8) / std::max<uint64_t>(window_codes, 1);
+                if (ratio > best_window) {
+                    best_window = ratio;
+                } else if (ratio * LZW_ADAPTIVE_THRESHOLD_DENOMINATOR < best_window * LZW_ADAPTIVE_THRESHOLD_NUMERATOR) {
+                    best_window = 0;
+                    clear();
+                }
 
-    // Output the last code if any
-    if (!current_string.empty()) {
-        result_stack.push(dictionary_[current_string]);
+                window_start = i;
+                window_codes = 0;
+            }
+        }
+        else if constexpr (VariableWidth)
+        {
+            // dictionary is full, start over with an empty one
+            clear();
+        }
+
+        // Update current string to the new character
+        current_code = c;
     }
 
-	// Write the compressed data to the output stream
-    for (const auto dumped_data = result_stack.dump();
-        const auto& byte : dumped_data) 
+    dictionary_.bytes_in += input_stream_.size();
+    input_stream_.clear();
+
+    // a compress(1) stream keeps its current string and the bits short of a byte for the next chunk
+    if (UnixCompress && !last_chunk)
+    {
+        dictionary_.pending_code = current_code;
+        dictionary_.carried = writer.carried();
+        dictionary_.carried_bits = writer.carried_bits();
+    }
+    else
     {
-		output_stream_.push_back(byte);
-	}
+        // Output the last code
+        if (current_code != no_code) {
+            emit(current_code);
+        }
 
-    // discarding this instance
-    discarding_this_instance = true;
-}
+        dictionary_.pending_code = no_code;
+        dictionary_.carried = 0;
+        dictionary_.carried_bits = 0;
 
-namespace std
-{
-    template < unsigned LzwCompressionBitSize >
-    struct hash < bitwise_numeric<LzwCompressionBitSize> >
-    {
-        size_t operator()(const bitwise_numeric<LzwCompressionBitSize>& b) const {
-            return static_cast<size_t>(b.template export_numeric<size_t>());
+        // Write the compressed data to the output stream
+        if constexpr (VariableWidth) {
+            writer.flush();
+        } else {
+            for (const auto dumped_data = result_stack.dump();
+                const auto& byte : dumped_data)
+            {
+                output_stream_.push_back(byte);
+            }
         }
-    };
+    }
+
+    dictionary_.bytes_out += output_stream_.size() - output_start;
+    dictionary_.next_code = next_code;
+    dictionary_.code_bits = code_bits;
+    dictionary_.group_codes = group_codes;
+
+    // discarding this instance
+    discarding_this_instance = true;
 }
 
 template < unsigned LzwCompressionBitSize, unsigned DictionarySize >
     requires (LzwCompressionBitSize > 8)
-void lzw<LzwCompressionBitSize, DictionarySize>::decompress()
+template < lzw_layout Layout >
+void lzw<LzwCompressionBitSize, DictionarySize>::decode(const bool last_chunk)
 {
+    constexpr bool VariableWidth = Layout == lzw_layout::variable || Layout == lzw_layout::unix_compress;
+    constexpr bool UnixCompress = Layout == lzw_layout::unix_compress;
+    constexpr bool Adaptive = Layout == lzw_layout::adaptive;
+    constexpr uint32_t no_code = UINT32_MAX;
+
+    // compress(1) moves on from 9 bit codes at 512 entries even if 9 bits is the maximum, they end up 10 bits wide
+    constexpr unsigned widest_bits = UnixCompress && LzwCompressionBitSize == LZW_INITIAL_BIT_SIZE ?
+        LZW_INITIAL_BIT_SIZE + 1 : LzwCompressionBitSize;
+
     if (discarding_this_instance)
     {
         throw std::invalid_argument("This instance has been discarded");
@@ -129,68 +338,312 @@ void lzw<LzwCompressionBitSize, DictionarySize>::decompress()
         return;
     }
 
-    std::unordered_map < bitwise_numeric < LzwCompressionBitSize >, std::string > dictionary_flipped;
-    std::vector<uint8_t> source_dump;
-    std::string current_string{};
-    bitwise_numeric_stack < LzwCompressionBitSize > source_stack;
-    bitwise_numeric<LzwCompressionBitSize> next_code =
-        bitwise_numeric < LzwCompressionBitSize>::make_bitwise_numeric_loosely(255);
+    if (!VariableWidth && solid_)
+    {
+        throw std::invalid_argument("Solid LZW instances only support variable width codes");
+    }
 
-    // dump source
-	std::ranges::reverse(input_stream_);
-    while (!input_stream_.empty())
+    if (UnixCompress && !solid_)
     {
-        const auto code = static_cast<uint8_t>(input_stream_.back());
-        input_stream_.pop_back();
-		source_dump.emplace_back(code);
+        throw std::invalid_argument("compress(1) streams need a dictionary shared by all of their chunks");
     }
 
-	// import source to stack
-	source_stack.lazy_import(source_dump);
+    // Initialize the dictionary, single byte strings are implicit (code == byte)
+    constexpr uint32_t code_limit = VariableWidth ? two_power(LzwCompressionBitSize) : DictionarySize;
+    const bool clear_code = VariableWidth && dictionary_.block_mode;
+    const uint32_t first_code = clear_code ? LZW_FIRST_CODE : 256;
+    const uint32_t reset_code = Adaptive ? DictionarySize : clear_code ? LZW_CLEAR_CODE : no_code;
+    if (!solid_ || dictionary_.prefix.empty())
+    {
+        dictionary_.prefix.resize(code_limit);
+        dictionary_.suffix.resize(code_limit);
+        dictionary_.length.resize(code_limit);
+        for (unsigned i = 0; i < 256; ++i) {
+            dictionary_.suffix[i] = static_cast<uint8_t>(i);
+            dictionary_.length[i] = 1;
+        }
 
-    // Initialize the flipped dictionary
-    for (int i = 0; i < 256; ++i) {
-        dictionary_flipped.emplace(bitwise_numeric<LzwCompressionBitSize>::make_bitwise_numeric_loosely(i),
-            std::string(1, static_cast<char>(i)));
+        dictionary_.next_code = first_code;
+        dictionary_.code_bits = VariableWidth ? LZW_INITIAL_BIT_SIZE : LzwCompressionBitSize;
+        dictionary_.pending_code = no_code;
     }
 
-    // The first code is popped out and assigned to current_string
-    current_string = static_cast<char>(source_stack[0].template export_numeric_force<uint8_t>());
-	output_stream_.push_back(dictionary_.at(current_string).template export_numeric_force<uint8_t>());
+    auto * const prefix = dictionary_.prefix.data();
+    auto * const suffix = dictionary_.suffix.data();
+    auto * const lengths = dictionary_.length.data();
+
+    // codes are read straight from the packed input, trailing bits shorter than a code are padding
+    bitwise_reader reader(input_stream_);
+    unsigned code_bits = dictionary_.code_bits;
+    uint32_t next_code = dictionary_.next_code;
+    uint64_t written = output_stream_.size();
+    output_stream_.resize(written + input_stream_.size() * 3);
 
-    for (uint64_t i = 1; i < source_stack.size(); i++)
+    // grow the output buffer so the next expansion fits in
+    auto reserve = [&](const uint64_t length)->void
     {
-        // Get input while there are codes are left to be received
-        const auto code = source_stack[i];
-        std::string entry;
-        // Check if the Decoder has codes to decode
-        if (code > next_code)
+        if (written + length > output_stream_.size()) {
+            output_stream_.resize(std::max(output_stream_.size() * 2, written + length));
+        }
+    };
+
+    // expand a code into the output buffer, the string is written from its tail towards its head
+    auto expand = [&](uint32_t code, const uint64_t length)->void
+    {
+        uint8_t * tail = output_stream_.data() + written + length - 1;
+        for (uint64_t i = 0; i < length; i++) {
+            *tail-- = suffix[code];
+            code = prefix[code];
+        }
+    };
+
+    // previous_code is empty at the beginning and after a dictionary reset,
+    // only a compress(1) stream carries it over from the chunk before
+    uint32_t previous_code = UnixCompress ? dictionary_.pending_code : no_code;
+
+    // decode one code, false once it ends the current run of codes by a reset or by widening them
+    auto decode_code = [&](const uint32_t code)->bool
+    {
+        if (code == reset_code)
         {
-            // entry = STRING + STRING[0]
-            entry = current_string + current_string[0];
+            next_code = first_code;
+            code_bits = VariableWidth ? LZW_INITIAL_BIT_SIZE : LzwCompressionBitSize;
+            previous_code = no_code;
+            return false;
         }
-        else
+
+        // The first code is a single byte, or any known string when a solid dictionary is carried over
+        if (previous_code == no_code)
         {
-            // entry = table[ord(arr[j])]
-			entry = dictionary_flipped.at(code);
+            if (code >= next_code) {
+                throw std::runtime_error("Corrupted LZW stream");
+            }
+
+            const uint64_t length = lengths[code];
+            reserve(length);
+            expand(code, length);
+            previous_code = code;
+            written += length;
+            return true;
         }
 
-        // append the new string
-        output_stream_.insert(output_stream_.end(), entry.begin(), entry.end());
+        uint64_t length = 0;
+        if (code < next_code)
+        {
+            // entry = table[code]
+            length = lengths[code];
+            reserve(length);
+            expand(code, length);
+        }
+        else if (code == next_code && next_code < code_limit)
+        {
+            // entry = STRING + STRING[0], STRING lands right where entry goes
+            length = lengths[previous_code] + 1;
+            reserve(length);
+            expand(previous_code, length - 1);
+            output_stream_[written + length - 1] = output_stream_[written];
+        }
+        else
+        {
+            throw std::runtime_error("Corrupted LZW stream");
+        }
 
-        // Check if the Table is full
-		if (dictionary_.size() < DictionarySize)
-		{
+        // Add STRING + entry[0] to the dictionary if the table is not full
+        if (next_code < code_limit)
+        {
+            prefix[next_code] = static_cast<code_type>(previous_code);
+            suffix[next_code] = output_stream_[written];
+            lengths[next_code] = static_cast<code_type>(lengths[previous_code] + 1);
             ++next_code;
-			dictionary_.emplace(current_string + entry[0], next_code);
-		    dictionary_flipped.emplace(next_code, current_string + entry[0]);
-		}
+        }
+
+        previous_code = code;
+        written += length;
+
+        // the encoder widens its codes right after it has emitted the one that filled the current width
+        if (VariableWidth && next_code > two_power<uint32_t>(code_bits) - 1 && code_bits < widest_bits) {
+            code_bits++;
+            return false;
+        }
+
+        return true;
+    };
+
+    if constexpr (UnixCompress)
+    {
+        // codes come in groups of 8, whatever follows the code that ends a run is padding up to the group end
+        while (reader.bits_left() > 0)
+        {
+            const uint64_t group_bits = code_bits * 8;
+            if (!last_chunk && reader.bits_left() < group_bits) {
+                break;
+            }
+
+            const uint64_t group_end = reader.position() + std::min<uint64_t>(group_bits, reader.bits_left());
+            while (reader.position() + code_bits <= group_end)
+            {
+                if (!decode_code(reader.read(code_bits))) {
+                    break;
+                }
+            }
+
+            reader.seek(group_end);
+        }
 
-		// Update current string
-		current_string = entry;
+        // leave the incomplete group for the next chunk
+        input_stream_.erase(input_stream_.begin(),
+            input_stream_.begin() + static_cast<std::ptrdiff_t>(reader.position() / 8));
+        dictionary_.pending_code = previous_code;
     }
+    else
+    {
+        // Get input while there are codes are left to be received
+        while (reader.bits_left() >= code_bits) {
+            decode_code(reader.read(code_bits));
+        }
 
+        input_stream_.clear();
+    }
+
+    output_stream_.resize(written);
+    dictionary_.next_code = next_code;
+    dictionary_.code_bits = code_bits;
     discarding_this_instance = true;
 }
 
+template < unsigned LzwCompressionBitSize, unsigned DictionarySize >
+    requires (LzwCompressionBitSize > 8)
+void lzw<LzwCompressionBitSize, DictionarySize>::compress()
+{
+    encode<lzw_layout::fixed>();
+}
+
+template < unsigned LzwCompressionBitSize, unsigned DictionarySize >
+    requires (LzwCompressionBitSize > 8)
+void lzw<LzwCompressionBitSize, DictionarySize>::decompress()
+{
+    decode<lzw_layout::fixed>();
+}
+
+template < unsigned LzwCompressionBitSize, unsigned DictionarySize >
+    requires (LzwCompressionBitSize > 8)
+void lzw<LzwCompressionBitSize, DictionarySize>::compress_adaptive()
+{
+    encode<lzw_layout::adaptive>();
+}
+
+template < unsigned LzwCompressionBitSize, unsigned DictionarySize >
+    requires (LzwCompressionBitSize > 8)
+void lzw<LzwCompressionBitSize, DictionarySize>::decompress_adaptive()
+{
+    decode<lzw_layout::adaptive>();
+}
+
+template < unsigned LzwCompressionBitSize, unsigned DictionarySize >
+    requires (LzwCompressionBitSize > 8)
+void lzw<LzwCompressionBitSize, DictionarySize>::compress_variable()
+{
+    encode<lzw_layout::variable>();
+}
+
+template < unsigned LzwCompressionBitSize, unsigned DictionarySize >
+    requires (LzwCompressionBitSize > 8)
+void lzw<LzwCompressionBitSize, DictionarySize>::decompress_variable()
+{
+    decode<lzw_layout::variable>();
+}
+
+template < unsigned LzwCompressionBitSize, unsigned DictionarySize >
+    requires (LzwCompressionBitSize > 8)
+void lzw<LzwCompressionBitSize, DictionarySize>::compress_unix(const bool last_chunk)
+{
+    encode<lzw_layout::unix_compress>(last_chunk);
+}
+
+template < unsigned LzwCompressionBitSize, unsigned DictionarySize >
+    requires (LzwCompressionBitSize > 8)
+void lzw<LzwCompressionBitSize, DictionarySize>::decompress_unix(const bool last_chunk)
+{
+    decode<lzw_layout::unix_compress>(last_chunk);
+}
+
+template < unsigned LzwCompressionBitSize, unsigned DictionarySize >
+    requires (LzwCompressionBitSize > 8)
+void lzw<LzwCompressionBitSize, DictionarySize>::prime(const std::vector < std::vector < uint8_t > > & strings)
+{
+    if (!solid_)
+    {
+        throw std::invalid_argument("Only solid LZW instances can be primed");
+    }
+
+    if (!dictionary_.slots.empty() || !dictionary_.prefix.empty())
+    {
+        throw std::invalid_argument("LZW dictionary is already in use");
+    }
+
+    // same layout as a fresh variable width dictionary, on both sides at once
+    constexpr uint32_t code_limit = two_power(LzwCompressionBitSize);
+    constexpr uint32_t prime_limit = LZW_FIRST_CODE
+        + (code_limit - LZW_FIRST_CODE) * LZW_PRIME_LIMIT_NUMERATOR / LZW_PRIME_LIMIT_DENOMINATOR;
+    reset_dictionary(code_limit - LZW_FIRST_CODE);
+    dictionary_.prefix.resize(code_limit);
+    dictionary_.suffix.resize(code_limit);
+    dictionary_.length.resize(code_limit);
+    for (unsigned i = 0; i < 256; ++i) {
+        dictionary_.suffix[i] = static_cast<uint8_t>(i);
+        dictionary_.length[i] = 1;
+    }
+
+    // walk every suffix down the trie, adding the nodes it is missing
+    auto * const slots = dictionary_.slots.data();
+    uint32_t next_code = LZW_FIRST_CODE;
+    for (const auto & string : strings)
+    {
+        for (uint64_t start = 0; start + 1 < string.size() && next_code < prime_limit; ++start)
+        {
+            uint32_t code = string[start];
+            for (uint64_t i = start + 1; i < string.size() && next_code < prime_limit; ++i)
+            {
+                const uint32_t key = ((code << 8) | string[i]) + 1;
+                const uint32_t slot = dictionary_probe(key);
+                if (slots[slot].key != key)
+                {
+                    slots[slot].key = key;
+                    slots[slot].code = next_code;
+                    dictionary_.prefix[next_code] = static_cast<code_type>(code);
+                    dictionary_.suffix[next_code] = string[i];
+                    dictionary_.length[next_code] = static_cast<code_type>(dictionary_.length[code] + 1);
+                    next_code++;
+                }
+
+                code = slots[slot].code;
+            }
+        }
+    }
+
+    // codes are as wide as they would be had the encoder added these strings itself
+    dictionary_.next_code = next_code;
+    dictionary_.code_bits = LZW_INITIAL_BIT_SIZE;
+    while (next_code > two_power<uint32_t>(dictionary_.code_bits) - 1 && dictionary_.code_bits < LzwCompressionBitSize) {
+        dictionary_.code_bits++;
+    }
+}
+
+template < typename Function >
+decltype(auto) lzw_dispatch(const unsigned bits, Function && function)
+{
+    switch (bits)
+    {
+        case 9:  return function(std::integral_constant < unsigned, 9 > { });
+        case 10: return function(std::integral_constant < unsigned, 10 > { });
+        case 11: return function(std::integral_constant < unsigned, 11 > { });
+        case 12: return function(std::integral_constant < unsigned, 12 > { });
+        case 13: return function(std::integral_constant < unsigned, 13 > { });
+        case 14: return function(std::integral_constant < unsigned, 14 > { });
+        case 15: return function(std::integral_constant < unsigned, 15 > { });
+        case 16: return function(std::integral_constant < unsigned, 16 > { });
+        default: throw std::invalid_argument("Unsupported LZW code width " + std::to_string(bits));
+    }
+}
+
 #endif // LZW_INL
@@ -25,6 +25,8 @@
 #include <vector>
 #include <array>
 #include <cstdint>
+#include <algorithm>
+#include <type_traits>
 
 #define COMPUTE_8_BIT_COMPLIMENT(bit) ((uint8_t)(0xFF >> (8 - (bit))))
 #define COMPUTE_N_BIT_COMPLIMENT(bit, nbit) (  ( (~(0x01ull << (bit))) << ((nbit) - (bit)) ) >> ((nbit) - (bit))  )
@@ -115,6 +117,142 @@ public:
     friend class bitwise_numeric_stack<BitSize>;
 };
 
+// smallest native unsigned integer holding Bits bits
+template < unsigned Bits > requires (Bits <= 64)
+using native_unsigned_t = std::conditional_t < (Bits <= 8), uint8_t,
+    std::conditional_t < (Bits <= 16), uint16_t,
+    std::conditional_t < (Bits <= 32), uint32_t, uint64_t > > >;
+
+// up to 64 bits, the value is kept in a native integer and masked to CurrentBitSize at compile time
+template <
+    const unsigned BitSize,
+    const unsigned CurrentBitSize,
+    const unsigned RequiredByteBlocks,
+    const unsigned AdditionalTailingBits >
+    requires (CurrentBitSize <= 64)
+class bitwise_numeric < BitSize, CurrentBitSize, RequiredByteBlocks, AdditionalTailingBits > {
+public:
+    using value_type = native_unsigned_t < CurrentBitSize >;
+
+private:
+    static constexpr value_type mask_ = static_cast<value_type>(~0ull >> (64 - CurrentBitSize));
+
+    struct byte {
+        uint8_t num {};
+        uint8_t bit {};
+    };
+
+    using data_type = std::array<byte, RequiredByteBlocks>;
+    value_type value_ = 0;
+    bool overflow_ = false;
+
+    constexpr explicit bitwise_numeric(const uint64_t value, const bool overflow = false)
+        : value_(static_cast<value_type>(value & mask_)), overflow_(overflow) { }
+
+public:
+    constexpr bitwise_numeric() = default;
+
+    // operations, carry out of + and borrow out of - are kept in is_overflow()
+    constexpr bitwise_numeric operator +(const bitwise_numeric & other) const {
+        const value_type sum = (value_ + other.value_) & mask_;
+        return bitwise_numeric(sum, sum < value_);
+    }
+
+    constexpr bitwise_numeric operator -(const bitwise_numeric & other) const {
+        return bitwise_numeric(value_ - other.value_, value_ < other.value_);
+    }
+
+    constexpr bitwise_numeric operator ^(const bitwise_numeric & other) const { return bitwise_numeric(value_ ^ other.value_); }
+    constexpr bitwise_numeric operator |(const bitwise_numeric & other) const { return bitwise_numeric(value_ | other.value_); }
+    constexpr bitwise_numeric operator &(const bitwise_numeric & other) const { return bitwise_numeric(value_ & other.value_); }
+    constexpr bitwise_numeric operator ~() const { return bitwise_numeric(~static_cast<uint64_t>(value_)); }
+
+    template < unsigned_integral Numeric > constexpr bitwise_numeric operator <<(const Numeric bits) const {
+        return bitwise_numeric(bits < CurrentBitSize ? static_cast<uint64_t>(value_) << bits : 0);
+    }
+
+    template < unsigned_integral Numeric > constexpr bitwise_numeric operator >>(const Numeric bits) const {
+        return bitwise_numeric(bits < CurrentBitSize ? static_cast<uint64_t>(value_) >> bits : 0);
+    }
+
+    constexpr bitwise_numeric & operator ++() { value_ = (value_ + 1) & mask_; return *this; }
+    constexpr bitwise_numeric & operator --() { value_ = (value_ - 1) & mask_; return *this; }
+
+    [[nodiscard]] constexpr bool is_overflow() const {
+        return overflow_;
+    }
+
+    // utilities
+    [[nodiscard]] constexpr bool operator ==(const bitwise_numeric & other) const { return value_ == other.value_; }
+    [[nodiscard]] constexpr bool operator !=(const bitwise_numeric & other) const { return value_ != other.value_; }
+    [[nodiscard]] constexpr bool operator <(const bitwise_numeric & other) const { return value_ < other.value_; }
+    [[nodiscard]] constexpr bool operator >(const bitwise_numeric & other) const { return value_ > other.value_; }
+    [[nodiscard]] constexpr bool operator >=(const bitwise_numeric & other) const { return value_ >= other.value_; }
+    [[nodiscard]] constexpr bool operator <=(const bitwise_numeric & other) const { return value_ <= other.value_; }
+
+    // the byte layout of the general representation, built on demand
+    [[nodiscard]] constexpr data_type dump() const
+    {
+        data_type ret { };
+        for (unsigned i = 0; i < RequiredByteBlocks; i++) {
+            ret[i].num = static_cast<uint8_t>(static_cast<uint64_t>(value_) >> (i * 8));
+            ret[i].bit = 8;
+        }
+
+        if constexpr (AdditionalTailingBits != 0) {
+            ret.back().bit = AdditionalTailingBits;
+        }
+
+        return ret;
+    }
+
+    [[nodiscard]] std::vector < uint8_t > dump_to_vector() const
+    {
+        std::vector < uint8_t > ret;
+        for (const auto & [num, bit] : dump()) {
+            ret.push_back(num);
+        }
+
+        return ret;
+    }
+
+    template < typename NumericType > requires (std::is_integral_v < NumericType >)
+    [[nodiscard]] constexpr NumericType export_numeric_force() const {
+        return static_cast<NumericType>(value_);
+    }
+
+    template < typename NumericType >
+    requires (std::is_integral_v < NumericType > && (sizeof(NumericType) * 8) >= BitSize)
+    [[nodiscard]] constexpr NumericType export_numeric() const {
+        return static_cast<NumericType>(value_);
+    }
+
+    template < unsigned_integral Numeric >
+    [[nodiscard]] static constexpr bitwise_numeric make_bitwise_numeric(const Numeric numeric) {
+        return bitwise_numeric(static_cast<uint64_t>(numeric));
+    }
+
+    // loosely structured
+    template < typename Numeric > requires std::is_integral_v < Numeric >
+    [[nodiscard]] static constexpr bitwise_numeric make_bitwise_numeric_loosely(const Numeric numeric) {
+        return make_bitwise_numeric(static_cast<std::make_unsigned_t<Numeric>>(numeric));
+    }
+
+    [[nodiscard]] static constexpr bitwise_numeric max_num() {
+        return bitwise_numeric(mask_);
+    }
+
+    [[nodiscard]] static constexpr bitwise_numeric static_hash()
+    {
+        return make_bitwise_numeric_loosely(
+            ((CurrentBitSize << (CurrentBitSize / 2)) | (CurrentBitSize ^ RequiredByteBlocks))
+            ^ (AdditionalTailingBits << std::min(CurrentBitSize - AdditionalTailingBits, 3u))
+        );
+    }
+
+    friend class bitwise_numeric_stack<BitSize>;
+};
+
 enum endian_t : uint8_t { little_endian, big_endian };
 
 template < unsigned BitSize >
@@ -163,6 +301,61 @@ public:
     [[nodiscard]] uint64_t hash() const;
 };
 
+// Incremental LSB-first reader over a packed stream, i.e., the bit order bitwise_numeric_stack::dump() produces
+class bitwise_reader {
+private:
+    const uint8_t * data_;
+    uint64_t size_;
+    uint64_t bit_offset_ = 0;
+
+public:
+    explicit bitwise_reader(const std::vector<uint8_t> & data) : data_(data.data()), size_(data.size()) { }
+
+    // read a value of at most 25 bits, bits beyond the end of the stream read as 0
+    [[nodiscard]] uint32_t read(unsigned bits);
+
+    [[nodiscard]] uint64_t bits_left() const {
+        return size_ * 8 - bit_offset_;
+    }
+
+    [[nodiscard]] uint64_t position() const {
+        return bit_offset_;
+    }
+
+    void seek(const uint64_t bit_offset) {
+        bit_offset_ = bit_offset;
+    }
+};
+
+// LSB-first writer, the counterpart of bitwise_reader
+class bitwise_writer {
+private:
+    std::vector<uint8_t> & output_;
+    uint64_t accumulator_ = 0;
+    unsigned accumulated_bits_ = 0;
+
+public:
+    explicit bitwise_writer(std::vector<uint8_t> & output) : output_(output) { }
+
+    // pick up the bits a previous writer left short of a whole byte
+    explicit bitwise_writer(std::vector<uint8_t> & output, const uint64_t carried, const unsigned carried_bits)
+        : output_(output), accumulator_(carried), accumulated_bits_(carried_bits) { }
+
+    // write a value of at most 32 bits
+    void write(uint32_t value, unsigned bits);
+
+    [[nodiscard]] uint64_t carried() const {
+        return accumulator_;
+    }
+
+    [[nodiscard]] unsigned carried_bits() const {
+        return accumulated_bits_;
+    }
+
+    // write out the last partial byte, padded with 0
+    void flush();
+};
+
 #endif //NUMERIC_H
 
 #include "numeric.inl"
@@ -27,32 +27,6 @@
 #include <array>
 #include "numeric.h"
 
-template < unsigned BitSize, unsigned RequiredBytes = BitSize / 8 + (BitSize % 8 == 0 ? 0 : 1) >
-[[nodiscard]]
-std::array < uint8_t, RequiredBytes >
-bitcopy(
-    uint64_t,
-    uint8_t,
-    uint8_t,
-    const std::vector < uint8_t >&);
-
-template < unsigned BitSize >
-[[nodiscard]]
-std::vector < uint8_t >
-bitcopy(
-    const uint64_t bit_start,
-    const uint8_t bit_copy,
-    const std::vector < uint8_t > & data)
-{
-	std::vector < uint8_t > ret{};
-	const uint64_t byte_starting = bit_start / 8;
-	const uint8_t bit_starting = bit_start % 8;
-    const auto array_from_bitcopy = bitcopy<BitSize>(byte_starting, bit_starting, bit_copy, data);
-	ret.resize(bit_copy / 8 + (bit_copy % 8 == 0 ? 0 : 1));
-	std::memcpy(ret.data(), array_from_bitcopy.data(), ret.size() * sizeof(uint8_t));
-    return ret;
-}
-
 template <
     const unsigned BitSize,
     const unsigned CurrentBitSize,
@@ -753,304 +727,129 @@ make_bitwise_numeric_loosely(Numeric numeric)
 template<unsigned BitSize>
 std::vector<uint8_t> bitwise_numeric_stack<BitSize>::dump() const
 {
-    struct conjunct_result
-	{
-    	uint8_t conjuncted;
-        uint8_t conj_effective_bits;
-    	uint8_t left_over;
-		uint8_t left_over_effective_bits;
-    };
+    // the low `bit` bits of every byte go into a 64-bit accumulator, lowest first, and leave it 32 bits at a time
+    std::vector<uint8_t> ret(stack_frame_.size() * required_byte_blocks + sizeof(uint32_t));
+    uint8_t * out = ret.data();
+    uint64_t accumulator = 0;
+    unsigned accumulated_bits = 0;
 
-	auto conjunct_two_uint8_t = [&](
-        const uint8_t previous,
-        const uint8_t previous_effective_bits,
-        const uint8_t current,
-        const uint8_t current_effective_bits)
-	->conjunct_result
-	{
-        // compute tail size
-		const uint8_t tail_size = std::min(
-			static_cast<uint8_t>(8 - previous_effective_bits), current_effective_bits);
-        // this is the bits in current that is going to be added to the previous, forming a bitwise conjunction
-        const uint8_t tailing_current = current
-			& COMPUTE_8_BIT_COMPLIMENT(tail_size)
-			& COMPUTE_8_BIT_COMPLIMENT(current_effective_bits);
-		// now, we add the tailing current to the previous, forming the conjunction we wanted
-		const auto conjuncted = static_cast<uint8_t>((tailing_current << previous_effective_bits) | previous);
-        // then, check for effective bits in conjunction
-        const uint8_t conj_effective_bits = std::min(
-            static_cast<uint8_t>(previous_effective_bits + current_effective_bits),
-            static_cast<uint8_t>(8));
-        // then, compute left_over byte
-		// first, remove current's tailing bits
-		uint8_t left_over = current
-			& COMPUTE_8_BIT_COMPLIMENT(current_effective_bits)
-			& (~COMPUTE_8_BIT_COMPLIMENT(tail_size));
-		// second, shift left_over to the right, removing the tail
-		left_over >>= tail_size;
-		// third, compute left_over effective bits
-		const uint8_t left_over_effective_bits = current_effective_bits - tail_size;
-
-		return conjunct_result
-			{   .conjuncted = conjuncted,
-				.conj_effective_bits = conj_effective_bits,
-				.left_over = left_over,
-				.left_over_effective_bits = left_over_effective_bits
-			};
-	};
+    auto flush_word = [&]()->void
+    {
+        if (accumulated_bits >= 32)
+        {
+            const auto word = static_cast<uint32_t>(accumulator);
+            std::memcpy(out, &word, sizeof(word));
+            out += sizeof(word);
+            accumulator >>= 32;
+            accumulated_bits -= 32;
+        }
+    };
 
-    std::vector<uint8_t> ret{};
-	conjunct_result result_holder {};
-    bool processed_for_result_holder = false;
     for (const auto & numeric : stack_frame_)
     {
-        // result is empty?
-        if (!processed_for_result_holder)
+        if constexpr (BitSize <= 32)
         {
-            // push the first numeric element
-            std::vector<uint8_t> first_element;
-			for (const auto& element : numeric.dump())
-			{
-				first_element.push_back(element.num);
-			}
-
-            result_holder.conj_effective_bits = numeric.dump().back().bit;
-			result_holder.conjuncted = numeric.dump().back().num;
-
-            ret.insert(ret.end(), first_element.begin(), first_element.end());
-            ret.pop_back(); // remove last item since it's recorded in result_holder
-            processed_for_result_holder = true;
+            // a native value of up to 32 bits always fits in
+            accumulator |= static_cast<uint64_t>(numeric.value_) << accumulated_bits;
+            accumulated_bits += BitSize;
+            flush_word();
         }
         else
         {
-            // iterate through all bytes
-            for (const auto& element : numeric.dump())
+            // wider ones go in byte by byte
+            for (const auto & [num, bit] : numeric.dump())
             {
-                // stitch the bytes
-                result_holder = conjunct_two_uint8_t(
-                    result_holder.conjuncted,
-                    result_holder.conj_effective_bits,
-                    element.num,
-                    element.bit);
-
-                // update info
-                if (result_holder.conj_effective_bits == 8)
-                {
-					ret.push_back(result_holder.conjuncted);
-					result_holder.conj_effective_bits = result_holder.left_over_effective_bits;
-					result_holder.conjuncted = result_holder.left_over;
-                    result_holder.left_over = 0;
-                    result_holder.left_over_effective_bits = 0;
-                }
+                accumulator |= static_cast<uint64_t>(num & COMPUTE_8_BIT_COMPLIMENT(bit)) << accumulated_bits;
+                accumulated_bits += bit;
+                flush_word();
             }
         }
     }
 
-    // if there are something left in the result_holder, add it to the result
-    if (result_holder.conj_effective_bits != 0)
+    // the last partial word, padded with 0
+    for (; accumulated_bits > 0; accumulated_bits -= std::min(accumulated_bits, 8u))
     {
-        ret.push_back(result_holder.conjuncted & COMPUTE_8_BIT_COMPLIMENT(result_holder.conj_effective_bits));
+        *out++ = static_cast<uint8_t>(accumulator);
+        accumulator >>= 8;
     }
 
+    ret.resize(static_cast<uint64_t>(out - ret.data()));
     return ret;
 }
 
-
-template < unsigned BitSize, unsigned RequiredBytes >
-[[nodiscard]]
-std::array < uint8_t, RequiredBytes > bitcopy(
-    const uint64_t byte_starting,
-    const uint8_t bit_starting,
-    const uint8_t bit_size,
-    const std::vector < uint8_t > & data)
+template<unsigned BitSize>
+void bitwise_numeric_stack<BitSize>::import(const std::vector<uint8_t>& data, const uint64_t expected_len)
 {
-	if (bit_starting > 8)
-	{
-		throw std::runtime_error("Bit starting must be less than 8");
-	}
-
-    const uint8_t first_copy_bits = std::min(static_cast<uint8_t>(8 - bit_starting), bit_size);
-    const uint8_t continuous_bytes = (bit_size - first_copy_bits) / 8;
-	const uint8_t last_copy_bits = (bit_size - first_copy_bits) % 8;
-    std::vector < uint8_t > complete_bytes {};
-    uint8_t fist_byte = 0, last_byte = 0;
-
-    // copy fist byte
-    fist_byte = data[byte_starting];
-	fist_byte &= ~COMPUTE_8_BIT_COMPLIMENT(bit_starting);
-	fist_byte >>= bit_starting;
-    //unpacked[0] = fist_byte;
-
-	// copy continuous bytes
-    complete_bytes.reserve(continuous_bytes);
-	for (uint8_t i = 0; i < continuous_bytes; i++)
-	{
-		complete_bytes.push_back(data[byte_starting + i + 1]);
-	}
-
-	// copy last byte
-	if (last_copy_bits != 0)
-	{
-		last_byte = data[byte_starting + continuous_bytes + 1];
-		last_byte &= COMPUTE_8_BIT_COMPLIMENT(last_copy_bits);
-		//unpacked[unpacked.size() - 1] = last_byte;
-	}
-
-	// return the result
-	std::vector < uint8_t > result{};
+    // clear stack
+    stack_frame_.clear();
+    stack_frame_.reserve(expected_len);
 
-	// we need to stitch the unpacked bytes, logic is exactly like dump()
-    struct conjunct_result
+    // up to 56 bits starting anywhere, bits past the end of data read as 0
+    auto read_bits = [&](const uint64_t bit_position, const unsigned bits)->uint64_t
     {
-        uint8_t conjuncted;
-        uint8_t conj_effective_bits;
-        uint8_t left_over;
-        uint8_t left_over_effective_bits;
+        const uint64_t first_byte = bit_position / 8;
+        const uint64_t last_byte = std::min<uint64_t>((bit_position + bits + 7) / 8, data.size());
+        uint64_t window = 0;
+        for (uint64_t i = first_byte; i < last_byte; i++) {
+            window |= static_cast<uint64_t>(data[i]) << ((i - first_byte) * 8);
+        }
+
+        return (window >> (bit_position % 8)) & (two_power<uint64_t>(bits) - 1);
     };
 
-    auto conjunct_two_uint8_t = [&](
-        const uint8_t previous,
-        const uint8_t previous_effective_bits,
-        const uint8_t current,
-        const uint8_t current_effective_bits)
-        ->conjunct_result
+    if constexpr (BitSize <= 56)
+    {
+        // one unaligned 64-bit load holds at least 57 bits past the current position, i.e.,
+        // 6 codes of 9 bits, 5 of 10 or 4 of 12 are taken out of every load
+        constexpr uint64_t mask = two_power<uint64_t>(BitSize) - 1;
+        constexpr unsigned codes_per_load = 57 / BitSize;
+        uint64_t index = 0, bit_position = 0;
+        for (; index + codes_per_load <= expected_len && bit_position / 8 + sizeof(uint64_t) <= data.size();
+            index += codes_per_load)
         {
-            // compute tail size
-            const uint8_t tail_size = std::min(
-                static_cast<uint8_t>(8 - previous_effective_bits), current_effective_bits);
-            // this is the bits in current that is going to be added to the previous, forming a bitwise conjunction
-            const uint8_t tailing_current = current
-                & COMPUTE_8_BIT_COMPLIMENT(tail_size)
-                & COMPUTE_8_BIT_COMPLIMENT(current_effective_bits);
-            // now, we add the tailing current to the previous, forming the conjunction we wanted
-            const auto conjuncted = static_cast<uint8_t>((tailing_current << previous_effective_bits) | previous);
-            // then, check for effective bits in conjuncted
-            const uint8_t conj_effective_bits = std::min(
-                static_cast<uint8_t>(previous_effective_bits + current_effective_bits),
-                static_cast<uint8_t>(8));
-            // then, compute left_over byte
-            // first, remove current's tailing bits
-            uint8_t left_over = current
-                & COMPUTE_8_BIT_COMPLIMENT(current_effective_bits)
-                & (~COMPUTE_8_BIT_COMPLIMENT(tail_size));
-            // second, shift left_over to the right, removing the tail
-            left_over >>= tail_size;
-            // third, compute left_over effective bits
-            const uint8_t left_over_effective_bits = current_effective_bits - tail_size;
-
-            return conjunct_result
-            { .conjuncted = conjuncted,
-                .conj_effective_bits = conj_effective_bits,
-                .left_over = left_over,
-                .left_over_effective_bits = left_over_effective_bits
-            };
-        };
-
-    conjunct_result result_holder{};
-    result_holder.conjuncted = fist_byte;
-	result_holder.conj_effective_bits = first_copy_bits;
-    auto iterate = [&](const uint8_t numeric, const uint8_t effective_bits)->void
-		{
-            // stitch the bytes
-            result_holder = conjunct_two_uint8_t(
-                result_holder.conjuncted,
-                result_holder.conj_effective_bits,
-                numeric,
-                effective_bits);
-
-            // update info
-            if (result_holder.conj_effective_bits == 8)
+            uint64_t window = 0;
+            std::memcpy(&window, data.data() + bit_position / 8, sizeof(window));
+            window >>= bit_position % 8;
+            for (unsigned code = 0; code < codes_per_load; code++)
             {
-                result.push_back(result_holder.conjuncted);
-                result_holder.conj_effective_bits = result_holder.left_over_effective_bits;
-                result_holder.conjuncted = result_holder.left_over;
-                result_holder.left_over = 0;
-                result_holder.left_over_effective_bits = 0;
+                stack_frame_.push_back(bitwise_numeric<BitSize>::make_bitwise_numeric(window & mask));
+                window >>= BitSize;
             }
-		};
 
-    // piece complete bytes
-    for (const auto& numeric : complete_bytes /* unpacked only contains bits of complete bytes */)
-    {
-        iterate(numeric, 8);
-    }
+            bit_position += codes_per_load * BitSize;
+        }
 
-    // piece last tailing byte (if there is one)
-    if (last_copy_bits != 0)
-    {
-        iterate(last_byte, last_copy_bits);
+        // the last few codes, near the end of data
+        for (; index < expected_len; index++, bit_position += BitSize) {
+            stack_frame_.push_back(bitwise_numeric<BitSize>::make_bitwise_numeric(read_bits(bit_position, BitSize)));
+        }
     }
-
-    // if there are something left in the result_holder, add it to the result
-    if (result_holder.conj_effective_bits != 0)
+    else if constexpr (BitSize <= 64)
     {
-        result.push_back(result_holder.conjuncted & COMPUTE_8_BIT_COMPLIMENT(result_holder.conj_effective_bits));
+        // wider than a load, still a native value
+        for (uint64_t index = 0; index < expected_len; index++)
+        {
+            const uint64_t bit_position = index * BitSize;
+            stack_frame_.push_back(bitwise_numeric<BitSize>::make_bitwise_numeric(read_bits(bit_position, 32)
+                | (read_bits(bit_position + 32, BitSize - 32) << 32)));
+        }
     }
-
-    // verify
-    std::array<uint8_t, BitSize / 8 + (BitSize % 8 == 0 ? 0 : 1)> ret;
-	if (result.size() != ret.size())
-	{
-		throw std::runtime_error("Error when copying bits, possibly a bug");
-	}
-
-    // copy result
-	std::memcpy(ret.data(), result.data(), ret.size() * sizeof(uint8_t));
-
-    return ret;
-}
-
-template<unsigned BitSize>
-void bitwise_numeric_stack<BitSize>::import(const std::vector<uint8_t>& data, const uint64_t expected_len)
-{
-    // clear stack
-    stack_frame_.clear();
-
-    uint64_t byte_offset = 0;
-    uint8_t bit_offset = 0;
-
-	auto add_offset = [&](const uint8_t off)->void {
-		// add offset
-		bit_offset += off;
-		while (bit_offset >= 8)
-		{
-			byte_offset++;
-			bit_offset -= 8;
-		}
-	};
-
-    auto import_numeric = [&](const std::array<uint8_t, BitSize / 8 + (BitSize % 8 == 0 ? 0 : 1)> & src)
+    else
+    {
+        // wider than a load, assembled byte by byte
+        for (uint64_t index = 0; index < expected_len; index++)
         {
-			// create a new numeric
-			bitwise_numeric<BitSize> numeric;
-			// copy over the data
-			for (uint8_t i = 0; i < numeric.dump().size(); i++)
-			{
-				numeric.data[i].num = src[i];
-				numeric.data[i].bit = 8;
-			}
-            numeric.data.back().bit = additional_tailing_bits;
-
-			// push to stack
-			stack_frame_.push_back(numeric);
-        };
+            bitwise_numeric<BitSize> numeric;
+            for (unsigned i = 0; i < numeric.data.size(); i++)
+            {
+                const unsigned bits = std::min(8u, BitSize - i * 8);
+                numeric.data[i].num = static_cast<uint8_t>(read_bits(index * BitSize + i * 8, bits));
+                numeric.data[i].bit = 8;
+            }
 
-    // import bits by bits
-    for (uint64_t i = 0; i < expected_len; i++)
-    {
-        // copy bits over
-        auto result =
-            bitcopy<BitSize>(
-                byte_offset,
-                bit_offset,
-                static_cast<uint8_t>(BitSize),
-                data);
-        // increase offset
-        add_offset(BitSize);
-
-        // import result
-        import_numeric(result);
-		//debug::log(result, "\n");
+            numeric.data.back().bit = additional_tailing_bits == 0 ? 8 : additional_tailing_bits;
+            stack_frame_.push_back(numeric);
+        }
     }
 }
 
@@ -1112,4 +911,43 @@ uint64_t bitwise_numeric_stack<BitSize>::hash() const
 	return get_checksum(big_endian);
 }
 
+inline uint32_t bitwise_reader::read(const unsigned bits)
+{
+    const uint64_t byte_offset = bit_offset_ / 8;
+    uint32_t window = 0;
+    if (byte_offset + sizeof(window) <= size_) {
+        std::memcpy(&window, data_ + byte_offset, sizeof(window));
+    } else {
+        for (uint64_t i = byte_offset; i < size_; i++) {
+            window |= static_cast<uint32_t>(data_[i]) << ((i - byte_offset) * 8);
+        }
+    }
+
+    window >>= bit_offset_ % 8;
+    bit_offset_ += bits;
+    return window & ((0x01u << bits) - 1);
+}
+
+inline void bitwise_writer::write(const uint32_t value, const unsigned bits)
+{
+    accumulator_ |= static_cast<uint64_t>(value & (0xFFFFFFFFu >> (32 - bits))) << accumulated_bits_;
+    accumulated_bits_ += bits;
+    while (accumulated_bits_ >= 8)
+    {
+        output_.push_back(static_cast<uint8_t>(accumulator_));
+        accumulator_ >>= 8;
+        accumulated_bits_ -= 8;
+    }
+}
+
+inline void bitwise_writer::flush()
+{
+    if (accumulated_bits_ != 0)
+    {
+        output_.push_back(static_cast<uint8_t>(accumulator_));
+        accumulator_ = 0;
+        accumulated_bits_ = 0;
+    }
+}
+
 #endif // NUMERIC_INL
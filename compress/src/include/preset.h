@@ -0,0 +1,57 @@
+/* preset.h
+ *
+ * Copyright 2025 Anivice Ives
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef PRESET_H
+#define PRESET_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "lzw.h"
+
+// preset dictionaries, strings common to a family of small inputs that prime the LZW dictionary before each group
+namespace preset {
+    // [Magic] [32bit ID] followed by [16bit Length] [String] until the end of the file
+    constexpr unsigned char magic[] = { 0x1f, 0x9d, 'D' };
+
+    // training picks segments of this many bytes, scored by the d-mers they hold that several samples share
+    constexpr uint64_t segment_size = 32;
+    constexpr uint64_t dmer_size = 8;
+    constexpr uint64_t default_size = 4096;
+
+    struct dictionary {
+        uint32_t id = 0;
+        std::vector < std::vector < uint8_t > > strings; // most useful first, priming stops once the table is full
+    };
+
+    // FNV-1a over the strings and their lengths, so that a dictionary is identified by its contents
+    [[nodiscard]] uint32_t identify(const std::vector < std::vector < uint8_t > > & strings);
+
+    // pick at most size bytes worth of segments out of the samples, one sample is one input to be compressed alone
+    [[nodiscard]] dictionary train(const std::vector < std::vector < uint8_t > > & samples, uint64_t size);
+
+    void save(const std::string & path, const dictionary & preset_dictionary);
+    [[nodiscard]] dictionary load(const std::string & path);
+
+    // solid LZW dictionary with max_bits wide codes, primed with the preset strings
+    [[nodiscard]] lzw_solid_dictionary prime(const dictionary & preset_dictionary, unsigned max_bits);
+}
+
+#endif //PRESET_H
@@ -0,0 +1,61 @@
+/* rans.h
+ *
+ * Copyright 2025 Anivice Ives
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef RANS_H
+#define RANS_H
+
+#include <array>
+#include <vector>
+#include <cstdint>
+
+// static model rANS, the symbol frequencies of a block are normalized to 2^scale_bits and stored up front,
+// four states take turns on the symbols and share one stream of 16-bit words
+namespace rans {
+    constexpr uint32_t scale_bits = 12;
+    constexpr uint32_t scale = 1u << scale_bits;
+    constexpr uint32_t state_lower_bound = 1u << 16; // states live in [2^16, 2^32)
+    constexpr uint64_t interleaved_states = 4;
+
+    using frequency_table = std::array < uint32_t, 256 >;
+
+    // every symbol present keeps at least 1, the rest goes where it saves the most bits
+    frequency_table normalize(const frequency_table & counts, uint64_t length);
+
+    // [first symbol][last symbol][frequencies of first..last], a frequency below 128 takes one byte,
+    // otherwise two with the top bit of the first one set
+    void write_frequencies(const frequency_table & freqs, std::vector < uint8_t > & output);
+    frequency_table read_frequencies(const std::vector < uint8_t > & input, uint64_t & position);
+
+class rans {
+private:
+    std::vector < uint8_t > & input_;
+    std::vector < uint8_t > & output_;
+
+public:
+    rans(std::vector<uint8_t> & input, std::vector<uint8_t> & output)
+        : input_(input), output_(output) {}
+
+    void encode();
+    void decode();
+};
+
+}
+
+#endif //RANS_H
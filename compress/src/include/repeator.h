@@ -27,6 +27,12 @@
 namespace repeator {
     constexpr uint8_t none = 0;
     constexpr uint8_t trimmed = 0x4F;
+    constexpr uint8_t runs = 0x52; // literal and repeat runs, lengths as varints
+    constexpr uint64_t min_repeat_run = 4; // shorter repeats cost more than they save in a literal run
+    constexpr uint8_t pattern = 0x50; // a short record repeated over and over
+    constexpr uint64_t min_pattern_period = 2; // a period of 1 is a repeat run
+    constexpr uint64_t max_pattern_period = 64;
+    constexpr uint64_t min_pattern_gain = 16; // bytes beyond the first period, to pay for splitting the runs around it
 
 class repeator {
 private:
@@ -34,6 +40,16 @@ private:
     std::vector < uint8_t > & output_;
 
     static void encode(std::vector<uint8_t> & input, std::vector<uint8_t> & output);
+    static void encode_runs(const std::vector<uint8_t> & input, uint64_t begin, uint64_t end, std::vector<uint8_t> & output);
+
+    struct periodic_run {
+        uint64_t begin;
+        uint64_t period;
+        uint64_t length;
+    };
+
+    // stretches worth a pattern record, by where they begin, the longest and then the smallest period first
+    static std::vector < periodic_run > find_periodic_runs(const std::vector<uint8_t> & input);
 public:
     repeator(std::vector<uint8_t> & input, std::vector<uint8_t> & output)
         : input_(input), output_(output) {}
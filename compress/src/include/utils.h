@@ -21,7 +21,9 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <bit>
 #include <cstdint>
+#include <cstring>
 #include <string>
 #include <vector>
 #include <chrono>
@@ -34,15 +36,46 @@ void set_binary();
 extern uint16_t BLOCK_SIZE;
 #define HASH_BITS (LZW_COMPRESSION_BIT_SIZE + (LZW_COMPRESSION_BIT_SIZE % 8))
 #define BLOCK_SIZE_MAX (32767)
+#define LZW_VARIABLE_MAX_BIT_SIZE_MIN (12)
+#define LZW_VARIABLE_MAX_BIT_SIZE_MAX (16)
+#define LZW_FIXED_BIT_SIZE_MIN (9)
+#define LZW_FIXED_BIT_SIZE_MAX (16)
+#define SOLID_GROUP_BLOCKS_MAX (65535)
 
 constexpr uint8_t used_lzw = 0xCA;
 constexpr uint8_t used_huffman = 0xED;
+constexpr uint8_t used_huffman_canonical = 0xEE;
+constexpr uint8_t used_huffman_interleaved = 0xEF;
+constexpr uint8_t used_huffman_pure = 0xEC;
+constexpr uint8_t used_huffman_repeat = 0xEB;
+constexpr uint8_t used_huffman_interleaved_repeat = 0xEA;
 constexpr uint8_t used_arithmetic = 0x77;
 constexpr uint8_t used_arithmetic_lzw = used_lzw ^ used_arithmetic;
+constexpr uint8_t used_arithmetic_range = 0x78;
+constexpr uint8_t used_arithmetic_range_lzw = used_lzw ^ used_arithmetic_range;
+constexpr uint8_t used_arithmetic_static = 0x76;
+constexpr uint8_t used_arithmetic_binary = 0x7B;
+constexpr uint8_t used_rans = 0xA5;
+constexpr uint8_t used_arithmetic_order1 = 0x79;
+constexpr uint8_t used_arithmetic_order2 = 0x7A;
 constexpr uint8_t used_plain = 0x00;
 constexpr uint8_t used_repeator = 0x81;
+constexpr uint8_t used_lzw_variable = 0xCB;
+constexpr uint8_t used_lzw_fixed = 0xCC;
+constexpr uint8_t used_lzw_solid = 0xCD;
+constexpr uint8_t used_lzw_adaptive = 0xCE;
+constexpr uint8_t used_lz77 = 0xC4;
+constexpr uint8_t used_solid_group = 0x5D;
 constexpr unsigned char magic[] = { 0x1f, 0x9d, LZW_COMPRESSION_BIT_SIZE };
 
+// compress(1) .Z header, the third byte holds the maximum code width and the block mode flag
+constexpr unsigned char unix_magic[] = { 0x1f, 0x9d };
+constexpr uint8_t unix_block_mode = 0x80;
+constexpr uint8_t unix_bits_mask = 0x1f;
+constexpr uint8_t unix_reserved_flags = 0x60;
+#define LZW_UNIX_MAX_BIT_SIZE_MIN (9)
+#define LZW_UNIX_CHUNK_SIZE (1024 * 1024)
+
 std::string seconds_to_human_readable_dates(uint64_t);
 
 template < typename Type >
@@ -67,4 +100,32 @@ bool is_utf8();
 uint8_t calculate_8bit(const std::vector<uint8_t> & data);
 bool pass_for_8bit(const std::vector<uint8_t> & data, uint8_t);
 
+inline uint64_t load_word(const uint8_t * data)
+{
+    uint64_t word;
+    std::memcpy(&word, data, sizeof(word));
+    return word;
+}
+
+// how many bytes from a and b on are equal, compared a word at a time
+inline uint64_t match_length(const uint8_t * a, const uint8_t * b, const uint64_t max)
+{
+    uint64_t length = 0;
+    while (length + sizeof(uint64_t) <= max)
+    {
+        if (const uint64_t diff = load_word(a + length) ^ load_word(b + length); diff != 0)
+        {
+            return length + (std::endian::native == std::endian::little
+                ? std::countr_zero(diff) : std::countl_zero(diff)) / 8;
+        }
+        length += sizeof(uint64_t);
+    }
+
+    while (length < max && a[length] == b[length]) {
+        length++;
+    }
+
+    return length;
+}
+
 #endif //UTILS_H
@@ -0,0 +1,248 @@
+/* lz77.cpp
+ *
+ * Copyright 2025 Anivice Ives
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "lz77.h"
+#include "utils.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+/*
+ * Layout:
+ *  [16bit length][sequences]
+ * A sequence is [token][literal length bytes][literals][16bit offset][match length bytes].
+ * The high nibble of the token is the literal length and the low nibble the match length minus min_match,
+ * 15 in either is followed by bytes added onto it, up to and including the first one below 255.
+ * The last sequence ends after its literals.
+ */
+
+namespace lz77
+{
+    static uint32_t load32(const uint8_t * data)
+    {
+        uint32_t word;
+        std::memcpy(&word, data, sizeof(word));
+        return word;
+    }
+
+    static uint32_t hash(const uint32_t word) {
+        return word * 2654435761u >> (32 - hash_bits);
+    }
+
+    void lz77::encode()
+    {
+        if (input_.empty()) {
+            return;
+        }
+
+        const uint8_t * data = input_.data();
+        const uint64_t size = input_.size();
+        const auto length = static_cast<uint16_t>(size);
+
+        // written through a pointer into room for the worst case, every byte a literal
+        const uint64_t base = output_.size();
+        output_.resize(base + 2 + size + size / 255 + 16);
+        uint8_t * out = output_.data() + base;
+        *out++ = static_cast<uint8_t>(length & 0xFF);
+        *out++ = static_cast<uint8_t>(length >> 8);
+
+        auto write_length = [&](uint64_t value)
+        {
+            while (value >= 255)
+            {
+                *out++ = 255;
+                value -= 255;
+            }
+            *out++ = static_cast<uint8_t>(value);
+        };
+
+        auto emit = [&](const uint64_t literal_begin, const uint64_t literal_end, const uint64_t offset, const uint64_t match)
+        {
+            const uint64_t literals = literal_end - literal_begin;
+            const uint64_t match_code = match - min_match;
+            *out++ = static_cast<uint8_t>((literals < 15 ? literals : 15) << 4
+                | (match == 0 ? 0 : (match_code < 15 ? match_code : 15)));
+            if (literals >= 15) {
+                write_length(literals - 15);
+            }
+            std::memcpy(out, data + literal_begin, literals);
+            out += literals;
+
+            if (match == 0) {
+                return;
+            }
+
+            *out++ = static_cast<uint8_t>(offset & 0xFF);
+            *out++ = static_cast<uint8_t>(offset >> 8);
+            if (match_code >= 15) {
+                write_length(match_code - 15);
+            }
+        };
+
+        std::array < int32_t, 1u << hash_bits > table;
+        table.fill(-1);
+
+        uint64_t anchor = 0, i = 0;
+        while (i + min_match <= size)
+        {
+            const uint32_t word = load32(data + i);
+            const auto slot = hash(word);
+            auto candidate = static_cast<int64_t>(table[slot]);
+            table[slot] = static_cast<int32_t>(i);
+
+            if (candidate < 0 || i - candidate > max_offset || load32(data + candidate) != word)
+            {
+                i += 1 + ((i - anchor) >> skip_shift);
+                continue;
+            }
+
+            // the match may start earlier than where it was found
+            while (i > anchor && candidate > 0 && data[i - 1] == data[candidate - 1])
+            {
+                i--;
+                candidate--;
+            }
+
+            const uint64_t match = min_match + match_length(data + i + min_match, data + candidate + min_match,
+                size - i - min_match);
+            emit(anchor, i, i - candidate, match);
+            i += match;
+            anchor = i;
+
+            // so that a match right after this one can be found
+            if (i + min_match <= size) {
+                table[hash(load32(data + i - 2))] = static_cast<int32_t>(i - 2);
+            }
+        }
+
+        emit(anchor, size, 0, 0);
+        output_.resize(out - output_.data());
+    }
+
+    void lz77::decode()
+    {
+        if (input_.empty()) {
+            return;
+        }
+
+        if (input_.size() < 3) {
+            throw std::runtime_error("Corrupted LZ77 block");
+        }
+
+        const uint8_t * in = input_.data();
+        const uint64_t in_size = input_.size();
+        const uint64_t length = in[0] | static_cast<uint64_t>(in[1]) << 8;
+        uint64_t position = 2;
+
+        auto read_length = [&](uint64_t value)->uint64_t
+        {
+            uint8_t byte;
+            do
+            {
+                if (position >= in_size) {
+                    throw std::runtime_error("Corrupted LZ77 block");
+                }
+                byte = in[position++];
+                value += byte;
+            } while (byte == 255);
+
+            return value;
+        };
+
+        // matches are copied 8 bytes at a time and may run past their end, into the padding
+        const uint64_t base = output_.size();
+        output_.resize(base + length + wild_copy_padding);
+        uint8_t * out = output_.data() + base;
+        uint64_t written = 0;
+
+        while (true)
+        {
+            if (position >= in_size) {
+                throw std::runtime_error("Corrupted LZ77 block");
+            }
+
+            const uint8_t token = in[position++];
+            uint64_t literals = token >> 4;
+            if (literals == 15) {
+                literals = read_length(literals);
+            }
+
+            if (literals > in_size - position || literals > length - written) {
+                throw std::runtime_error("Corrupted LZ77 block");
+            }
+
+            // short literals are copied 16 bytes at once when the input has them, the rest goes into the padding
+            if (literals <= wild_copy_padding && in_size - position >= wild_copy_padding) {
+                std::memcpy(out + written, in + position, wild_copy_padding);
+            } else {
+                std::memcpy(out + written, in + position, literals);
+            }
+            position += literals;
+            written += literals;
+
+            if (position == in_size) {
+                break;
+            }
+
+            if (in_size - position < 2) {
+                throw std::runtime_error("Corrupted LZ77 block");
+            }
+
+            const uint64_t offset = in[position] | static_cast<uint64_t>(in[position + 1]) << 8;
+            position += 2;
+            uint64_t match = token & 15;
+            if (match == 15) {
+                match = read_length(match);
+            }
+            match += min_match;
+
+            if (offset == 0 || offset > written || match > length - written) {
+                throw std::runtime_error("Corrupted LZ77 block");
+            }
+
+            uint8_t * destination = out + written;
+            const uint8_t * source = destination - offset;
+            if (offset >= sizeof(uint64_t))
+            {
+                for (uint64_t copied = 0; copied < match; copied += sizeof(uint64_t)) {
+                    std::memcpy(destination + copied, source + copied, sizeof(uint64_t));
+                }
+            }
+            else
+            {
+                // overlapping, the offset bytes repeat, so what has been written is doubled until it is long enough
+                for (uint64_t copied = 0; copied < offset; copied++) {
+                    destination[copied] = source[copied];
+                }
+                for (uint64_t copied = offset; copied < match; copied *= 2) {
+                    std::memcpy(destination + copied, destination, std::min(copied, match - copied));
+                }
+            }
+            written += match;
+        }
+
+        if (written != length) {
+            throw std::runtime_error("Corrupted LZ77 block");
+        }
+
+        output_.resize(base + length);
+    }
+}
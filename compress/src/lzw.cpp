@@ -0,0 +1,31 @@
+/* lzw.cpp
+ *
+ * Copyright 2025 Anivice Ives
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "lzw.h"
+
+// every code width reachable through lzw_dispatch is compiled once, here
+template class lzw < 9 >;
+template class lzw < 10 >;
+template class lzw < 11 >;
+template class lzw < 12 >;
+template class lzw < 13 >;
+template class lzw < 14 >;
+template class lzw < 15 >;
+template class lzw < 16 >;
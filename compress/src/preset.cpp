@@ -0,0 +1,224 @@
+/* preset.cpp
+ *
+ * Copyright 2025 Anivice Ives
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "preset.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <ranges>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace preset {
+
+uint32_t identify(const std::vector < std::vector < uint8_t > > & strings)
+{
+    uint32_t hash = 0x811C9DC5;
+    auto mix = [&hash](const uint8_t byte)->void
+    {
+        hash ^= byte;
+        hash *= 0x01000193;
+    };
+
+    for (const auto & string : strings)
+    {
+        mix(static_cast<uint8_t>(string.size() & 0xFF));
+        mix(static_cast<uint8_t>(string.size() >> 8));
+        std::ranges::for_each(string, mix);
+    }
+
+    return hash;
+}
+
+dictionary train(const std::vector < std::vector < uint8_t > > & samples, const uint64_t size)
+{
+    auto dmer_at = [](const std::vector < uint8_t > & sample, const uint64_t position)->uint64_t
+    {
+        uint64_t dmer = 0;
+        std::memcpy(&dmer, sample.data() + position, dmer_size);
+        return dmer;
+    };
+
+    // how many samples each d-mer shows up in, counted once per sample
+    std::unordered_map < uint64_t, uint64_t > frequency;
+    std::unordered_map < uint64_t, uint64_t > last_seen;
+    for (uint64_t index = 0; index < samples.size(); index++)
+    {
+        const auto & sample = samples[index];
+        for (uint64_t position = 0; position + dmer_size <= sample.size(); position++)
+        {
+            const auto dmer = dmer_at(sample, position);
+            if (auto & seen = last_seen[dmer]; seen != index + 1)
+            {
+                seen = index + 1;
+                frequency[dmer]++;
+            }
+        }
+    }
+
+    // every segment that fits in a sample is a candidate
+    std::vector < std::pair < uint64_t /* sample */, uint64_t /* position */ > > candidates;
+    for (uint64_t index = 0; index < samples.size(); index++)
+    {
+        for (uint64_t position = 0; position + segment_size <= samples[index].size(); position++) {
+            candidates.emplace_back(index, position);
+        }
+    }
+
+    // d-mers only one sample holds are worth nothing to the others
+    auto score_of = [&](const std::pair < uint64_t, uint64_t > & candidate)->uint64_t
+    {
+        uint64_t score = 0;
+        for (uint64_t position = candidate.second; position + dmer_size <= candidate.second + segment_size; position++)
+        {
+            if (const auto it = frequency.find(dmer_at(samples[candidate.first], position));
+                it != frequency.end() && it->second > 1)
+            {
+                score += it->second;
+            }
+        }
+
+        return score;
+    };
+
+    // the candidates are split into epochs, each one gives its best segment, whose d-mers then count no more
+    std::vector < std::pair < uint64_t /* score */, std::vector < uint8_t > > > segments;
+    const uint64_t epochs = std::max<uint64_t>(1, size / segment_size);
+    const uint64_t epoch_size = std::max<uint64_t>(1, candidates.size() / epochs);
+    for (uint64_t epoch_start = 0; epoch_start < candidates.size(); epoch_start += epoch_size)
+    {
+        uint64_t best_score = 0;
+        const std::pair < uint64_t, uint64_t > * best = nullptr;
+        for (uint64_t i = epoch_start; i < std::min<uint64_t>(epoch_start + epoch_size, candidates.size()); i++)
+        {
+            if (const auto score = score_of(candidates[i]); score > best_score)
+            {
+                best_score = score;
+                best = &candidates[i];
+            }
+        }
+
+        if (best == nullptr) {
+            continue;
+        }
+
+        const auto & sample = samples[best->first];
+        for (uint64_t position = best->second; position + dmer_size <= best->second + segment_size; position++) {
+            frequency[dmer_at(sample, position)] = 0;
+        }
+
+        segments.emplace_back(best_score, std::vector < uint8_t > (
+            sample.begin() + static_cast<std::ptrdiff_t>(best->second),
+            sample.begin() + static_cast<std::ptrdiff_t>(best->second + segment_size)));
+    }
+
+    std::ranges::stable_sort(segments, [](const auto & left, const auto & right)->bool {
+        return left.first > right.first;
+    });
+
+    dictionary result;
+    uint64_t total = 0;
+    for (auto & segment : segments | std::views::values)
+    {
+        if (total + segment.size() > size) {
+            break;
+        }
+
+        total += segment.size();
+        result.strings.emplace_back(std::move(segment));
+    }
+
+    result.id = identify(result.strings);
+    return result;
+}
+
+void save(const std::string & path, const dictionary & preset_dictionary)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open dictionary file: " + path);
+    }
+
+    file.write(reinterpret_cast<const char *>(magic), sizeof(magic));
+    file.write(reinterpret_cast<const char *>(&preset_dictionary.id), sizeof(preset_dictionary.id));
+    for (const auto & string : preset_dictionary.strings)
+    {
+        const auto length = static_cast<uint16_t>(string.size());
+        file.write(reinterpret_cast<const char *>(&length), sizeof(length));
+        file.write(reinterpret_cast<const char *>(string.data()), static_cast<std::streamsize>(string.size()));
+    }
+
+    if (!file.good()) {
+        throw std::runtime_error("Failed to write dictionary file: " + path);
+    }
+}
+
+dictionary load(const std::string & path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open dictionary file: " + path);
+    }
+
+    unsigned char magic_buff[sizeof(magic)] { };
+    file.read(reinterpret_cast<char *>(magic_buff), sizeof(magic_buff));
+    if (std::memcmp(magic_buff, magic, sizeof(magic)) != 0) {
+        throw std::runtime_error("Not a dictionary file: " + path);
+    }
+
+    dictionary result;
+    file.read(reinterpret_cast<char *>(&result.id), sizeof(result.id));
+    if (!file.good()) {
+        throw std::runtime_error("Dictionary file truncated: " + path);
+    }
+
+    uint16_t length = 0;
+    while (file.read(reinterpret_cast<char *>(&length), sizeof(length)))
+    {
+        std::vector < uint8_t > string(length);
+        file.read(reinterpret_cast<char *>(string.data()), length);
+        if (file.gcount() != length) {
+            throw std::runtime_error("Dictionary file truncated: " + path);
+        }
+
+        result.strings.emplace_back(std::move(string));
+    }
+
+    if (identify(result.strings) != result.id) {
+        throw std::runtime_error("Dictionary file corrupted: " + path);
+    }
+
+    return result;
+}
+
+lzw_solid_dictionary prime(const dictionary & preset_dictionary, const unsigned max_bits)
+{
+    lzw_solid_dictionary result;
+    std::vector < uint8_t > input, output;
+    lzw_dispatch(max_bits, [&](auto bits)->void
+    {
+        lzw <decltype(bits)::value> primer(input, output, result);
+        primer.prime(preset_dictionary.strings);
+    });
+
+    return result;
+}
+
+}
@@ -0,0 +1,257 @@
+/* rans.cpp
+ *
+ * Copyright 2025 Anivice Ives
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "rans.h"
+#include <algorithm>
+#include <cmath>
+#include <ranges>
+#include <stdexcept>
+
+/*
+ * Layout:
+ *  [16bit length][frequency table][4 x 32bit final states][16bit words]
+ */
+
+namespace rans
+{
+    frequency_table normalize(const frequency_table & counts, const uint64_t length)
+    {
+        frequency_table freqs{};
+        uint64_t sum = 0;
+        for (int i = 0; i < 256; i++)
+        {
+            if (counts[i] == 0) {
+                continue;
+            }
+
+            const auto scaled = static_cast<uint32_t>((static_cast<uint64_t>(counts[i]) * scale + length / 2) / length);
+            freqs[i] = std::max(scaled, 1u);
+            sum += freqs[i];
+        }
+
+        // rounding leaves the sum a little off, move one slot at a time
+        while (sum != scale)
+        {
+            const bool shrink = sum > scale;
+            int best = -1;
+            double best_cost = 0;
+            for (int i = 0; i < 256; i++)
+            {
+                if (freqs[i] == 0 || (shrink && freqs[i] == 1)) {
+                    continue;
+                }
+
+                // bits lost by taking a slot away, or bits saved by giving one
+                const double cost = shrink
+                    ? counts[i] * std::log2(static_cast<double>(freqs[i]) / (freqs[i] - 1))
+                    : counts[i] * std::log2(static_cast<double>(freqs[i] + 1) / freqs[i]);
+                if (best == -1 || (shrink ? cost < best_cost : cost > best_cost)) {
+                    best = i;
+                    best_cost = cost;
+                }
+            }
+
+            if (shrink) {
+                freqs[best]--;
+                sum--;
+            } else {
+                freqs[best]++;
+                sum++;
+            }
+        }
+
+        return freqs;
+    }
+
+    void write_frequencies(const frequency_table & freqs, std::vector < uint8_t > & output)
+    {
+        int first = 0, last = 255;
+        while (first < 255 && freqs[first] == 0) first++;
+        while (last > 0 && freqs[last] == 0) last--;
+
+        output.push_back(static_cast<uint8_t>(first));
+        output.push_back(static_cast<uint8_t>(last));
+        for (int i = first; i <= last; i++)
+        {
+            if (freqs[i] < 0x80) {
+                output.push_back(static_cast<uint8_t>(freqs[i]));
+            } else {
+                output.push_back(static_cast<uint8_t>(0x80 | freqs[i] >> 8));
+                output.push_back(static_cast<uint8_t>(freqs[i] & 0xFF));
+            }
+        }
+    }
+
+    frequency_table read_frequencies(const std::vector < uint8_t > & input, uint64_t & position)
+    {
+        auto get = [&]()->uint8_t
+        {
+            if (position >= input.size()) {
+                throw std::runtime_error("Corrupted frequency table");
+            }
+
+            return input[position++];
+        };
+
+        const int first = get();
+        const int last = get();
+        if (first > last) {
+            throw std::runtime_error("Corrupted frequency table");
+        }
+
+        frequency_table freqs{};
+        uint32_t sum = 0;
+        for (int i = first; i <= last; i++)
+        {
+            freqs[i] = get();
+            if (freqs[i] & 0x80) {
+                freqs[i] = (freqs[i] & 0x7F) << 8 | get();
+            }
+            sum += freqs[i];
+        }
+
+        if (sum != scale) {
+            throw std::runtime_error("Corrupted frequency table");
+        }
+
+        return freqs;
+    }
+
+    void rans::encode()
+    {
+        if (input_.empty()) {
+            return;
+        }
+
+        frequency_table counts{};
+        for (const auto c : input_) {
+            counts[c]++;
+        }
+
+        const auto freqs = normalize(counts, input_.size());
+        frequency_table starts{};
+        for (int i = 1; i < 256; i++) {
+            starts[i] = starts[i - 1] + freqs[i - 1];
+        }
+
+        const auto length = static_cast<uint16_t>(input_.size());
+        output_.push_back(static_cast<uint8_t>(length & 0xFF));
+        output_.push_back(static_cast<uint8_t>(length >> 8));
+        write_frequencies(freqs, output_);
+
+        // rANS runs backwards, the last symbol is encoded first so that the decoder reads forwards
+        std::array < uint32_t, interleaved_states > states{};
+        states.fill(state_lower_bound);
+        std::vector < uint16_t > words;
+        words.reserve(input_.size() / 2 + 1);
+        for (uint64_t i = input_.size(); i > 0; i--)
+        {
+            const auto symbol = input_[i - 1];
+            auto & state = states[(i - 1) % interleaved_states];
+            const uint32_t freq = freqs[symbol];
+
+            // keep the state below 2^32 after encoding
+            if (state >= static_cast<uint64_t>(freq) << (32 - scale_bits))
+            {
+                words.push_back(static_cast<uint16_t>(state & 0xFFFF));
+                state >>= 16;
+            }
+
+            state = (state / freq << scale_bits) + state % freq + starts[symbol];
+        }
+
+        for (const auto state : states) {
+            for (int shift = 0; shift < 32; shift += 8) {
+                output_.push_back(static_cast<uint8_t>(state >> shift));
+            }
+        }
+
+        for (const auto word : std::ranges::reverse_view(words)) {
+            output_.push_back(static_cast<uint8_t>(word & 0xFF));
+            output_.push_back(static_cast<uint8_t>(word >> 8));
+        }
+    }
+
+    void rans::decode()
+    {
+        if (input_.empty()) {
+            return;
+        }
+
+        uint64_t position = 0;
+        auto get = [&]()->uint8_t
+        {
+            if (position >= input_.size()) {
+                throw std::runtime_error("Corrupted rANS stream");
+            }
+
+            return input_[position++];
+        };
+
+        const uint16_t length = get() | static_cast<uint16_t>(get() << 8);
+        const auto freqs = read_frequencies(input_, position);
+
+        // one entry per slot, so that a symbol is decoded with a single lookup
+        struct slot {
+            uint16_t freq;
+            uint16_t offset; // slot - start of the symbol
+            uint8_t symbol;
+        };
+
+        std::vector < slot > slots(scale);
+        for (uint32_t i = 0, start = 0; i < 256; i++)
+        {
+            for (uint32_t j = 0; j < freqs[i]; j++) {
+                slots[start + j] = { static_cast<uint16_t>(freqs[i]), static_cast<uint16_t>(j), static_cast<uint8_t>(i) };
+            }
+            start += freqs[i];
+        }
+
+        std::array < uint32_t, interleaved_states > states{};
+        for (auto & state : states) {
+            for (int shift = 0; shift < 32; shift += 8) {
+                state |= static_cast<uint32_t>(get()) << shift;
+            }
+        }
+
+        // the words run out exactly with the last symbol
+        const uint8_t * words = input_.data() + position;
+        const uint64_t word_count = (input_.size() - position) / 2;
+        uint64_t word = 0;
+
+        output_.reserve(output_.size() + length);
+        for (uint64_t i = 0; i < length; i++)
+        {
+            auto & state = states[i % interleaved_states];
+            const auto & [freq, offset, symbol] = slots[state & (scale - 1)];
+            output_.push_back(symbol);
+            state = freq * (state >> scale_bits) + offset;
+            if (state < state_lower_bound)
+            {
+                if (word >= word_count) {
+                    throw std::runtime_error("Corrupted rANS stream");
+                }
+
+                state = state << 16 | words[word * 2] | static_cast<uint32_t>(words[word * 2 + 1]) << 8;
+                word++;
+            }
+        }
+    }
+}
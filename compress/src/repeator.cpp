@@ -19,12 +19,133 @@
  */
 
 #include "repeator.h"
-#include <utility>
-#include <ranges>
+#include "utils.h"
 #include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+/*
+ * A block is a sequence of records:
+ *  [none][16bit length][bytes]
+ *  [trimmed][16bit length][byte]
+ *  [runs][varint length][runs...]
+ *  [pattern][varint period][varint length][period bytes], the bytes repeated up to length
+ * Within runs, a varint header with the lowest bit set is a repeat run of (header >> 1) + min_repeat_run
+ * copies of the byte after it, otherwise a literal run of (header >> 1) + 1 bytes follows.
+ */
 
 namespace repeator
 {
+    // 7 bits at a time, lowest first, the top bit tells whether more follow
+    static void write_varint(uint64_t value, std::vector<uint8_t> & output)
+    {
+        while (value >= 0x80)
+        {
+            output.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        output.push_back(static_cast<uint8_t>(value));
+    }
+
+    static bool worth_a_record(const std::vector<uint8_t> & input, const uint64_t begin,
+        const uint64_t period, const uint64_t length)
+    {
+        if (length < 2 * period || length - period < min_pattern_gain) {
+            return false;
+        }
+
+        // a pattern of one byte over and over is a repeat run, and left to encode_runs
+        for (uint64_t i = 1; i < period; i++) {
+            if (input[begin + i] != input[begin]) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    std::vector < repeator::periodic_run > repeator::find_periodic_runs(const std::vector<uint8_t> & input)
+    {
+        std::vector < periodic_run > found;
+        const uint8_t * data = input.data();
+        const uint64_t size = input.size();
+
+        for (uint64_t period = min_pattern_period; period <= max_pattern_period; period++)
+        {
+            // a stretch long enough to be worth a record covers a whole word at a multiple of 8,
+            // so only those are compared and a hit is then extended both ways
+            for (uint64_t i = 0; i + period + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+            {
+                if (load_word(data + i) != load_word(data + i + period)) {
+                    continue;
+                }
+
+                uint64_t begin = i;
+                while (begin > 0 && data[begin - 1] == data[begin - 1 + period]) {
+                    begin--;
+                }
+
+                const uint64_t equal = i - begin + match_length(data + i, data + i + period, size - i - period);
+                if (worth_a_record(input, begin, period, period + equal)) {
+                    found.push_back({ begin, period, period + equal });
+                }
+
+                // carry on past the stretch
+                if (begin + equal > i + sizeof(uint64_t)) {
+                    i = begin + equal - sizeof(uint64_t);
+                }
+            }
+        }
+
+        std::ranges::sort(found, [](const periodic_run & a, const periodic_run & b)
+        {
+            if (a.begin != b.begin) return a.begin < b.begin;
+            if (a.length != b.length) return a.length > b.length;
+            return a.period < b.period;
+        });
+
+        return found;
+    }
+
+    void repeator::encode_runs(const std::vector<uint8_t> & input, const uint64_t begin, const uint64_t end,
+        std::vector<uint8_t> & output)
+    {
+        output.push_back(runs);
+        write_varint(end - begin, output);
+
+        uint64_t literal_begin = begin;
+        auto flush_literals = [&](const uint64_t literal_end)
+        {
+            if (literal_end > literal_begin)
+            {
+                write_varint((literal_end - literal_begin - 1) << 1, output);
+                output.insert(output.end(), input.begin() + static_cast<std::ptrdiff_t>(literal_begin),
+                    input.begin() + static_cast<std::ptrdiff_t>(literal_end));
+            }
+        };
+
+        uint64_t i = begin;
+        while (i < end)
+        {
+            uint64_t run = 1;
+            while (i + run < end && input[i + run] == input[i]) {
+                run++;
+            }
+
+            if (run >= min_repeat_run)
+            {
+                flush_literals(i);
+                write_varint((run - min_repeat_run) << 1 | 1, output);
+                output.push_back(input[i]);
+                literal_begin = i + run;
+            }
+
+            i += run;
+        }
+
+        flush_literals(end);
+    }
+
     void repeator::encode(std::vector<uint8_t> & input, std::vector<uint8_t> & output)
     {
         if (input.empty()) {
@@ -36,6 +157,43 @@ namespace repeator
         {
             if (in != c)
             {
+                // repeated records and runs within the block, unless there are too few to pay for their headers
+                std::vector<uint8_t> records;
+                uint64_t runs_begin = 0;
+                for (auto [run_begin, period, length] : find_periodic_runs(input))
+                {
+                    // what overlaps the record before is cut off, a suffix still repeats with the same period
+                    if (run_begin < runs_begin)
+                    {
+                        const auto overlap = runs_begin - run_begin;
+                        if (overlap >= length || !worth_a_record(input, runs_begin, period, length - overlap)) {
+                            continue;
+                        }
+                        run_begin = runs_begin;
+                        length -= overlap;
+                    }
+
+                    if (run_begin > runs_begin) {
+                        encode_runs(input, runs_begin, run_begin, records);
+                    }
+
+                    records.push_back(pattern);
+                    write_varint(period, records);
+                    write_varint(length, records);
+                    records.insert(end(records), begin(input) + static_cast<std::ptrdiff_t>(run_begin),
+                        begin(input) + static_cast<std::ptrdiff_t>(run_begin + period));
+                    runs_begin = run_begin + length;
+                }
+
+                if (runs_begin < input.size()) {
+                    encode_runs(input, runs_begin, input.size(), records);
+                }
+
+                if (records.size() < input.size() + 3) {
+                    output.insert(end(output), begin(records), end(records));
+                    return;
+                }
+
                 output.push_back(none);
                 uint16_t len = input.size();
                 output.push_back(reinterpret_cast<uint8_t *>(&len)[0]);
@@ -62,35 +220,130 @@ namespace repeator
             return;
         }
 
-        std::ranges::reverse(input_);
+        uint64_t position = 0;
+        auto require = [&](const uint64_t length)
+        {
+            if (input_.size() - position < length) {
+                throw std::runtime_error("Corrupted repeator block");
+            }
+        };
 
-        auto getc = [&]()->int
+        auto read_varint = [&]()->uint64_t
         {
-            if (input_.empty()) {
-                return -1;
+            uint64_t value = 0;
+            for (int shift = 0; shift < 64; shift += 7)
+            {
+                require(1);
+                const uint8_t byte = input_[position++];
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) {
+                    return value;
+                }
             }
 
-            const auto c = input_.back();
-            input_.pop_back();
-            return c;
+            throw std::runtime_error("Corrupted repeator block");
         };
 
-        while (!input_.empty())
+        // no block decodes to more than UINT16_MAX bytes, whatever its records ask for
+        const auto output_begin = output_.size();
+        auto room = [&](const uint64_t length)
         {
-            const auto method = getc();
-            uint16_t len = 0;
-            reinterpret_cast<uint8_t *>(&len)[0] = getc();
-            reinterpret_cast<uint8_t *>(&len)[1] = getc();
+            if (length > UINT16_MAX - (output_.size() - output_begin)) {
+                throw std::runtime_error("Corrupted repeator block");
+            }
+        };
 
-            if (method == none) {
-                output_.reserve(len + output_.size());
-                for (int i = 0; i < len; i++) {
-                    output_.push_back(getc());
+        // runs go straight into the output, repeats by memset and literals by memcpy
+        auto append_repeat = [&](const uint64_t length, const uint8_t byte)
+        {
+            if (length == 0) {
+                return;
+            }
+
+            const auto offset = output_.size();
+            output_.resize(offset + length);
+            std::memset(output_.data() + offset, byte, length);
+        };
+
+        auto append_literal = [&](const uint64_t length)
+        {
+            require(length);
+            if (length == 0) {
+                return;
+            }
+
+            const auto offset = output_.size();
+            output_.resize(offset + length);
+            std::memcpy(output_.data() + offset, input_.data() + position, length);
+            position += length;
+        };
+
+        while (position < input_.size())
+        {
+            const auto method = input_[position++];
+            if (method == runs)
+            {
+                const auto length = read_varint();
+                if (length > UINT16_MAX) {
+                    throw std::runtime_error("Corrupted repeator block");
                 }
+                room(length);
+                const auto end = output_.size() + length;
+                output_.reserve(end);
+                while (output_.size() < end)
+                {
+                    const auto header = read_varint();
+                    const auto run = (header >> 1) + ((header & 1) ? min_repeat_run : 1);
+                    if (run > end - output_.size()) {
+                        throw std::runtime_error("Corrupted repeator block");
+                    }
+
+                    if (header & 1)
+                    {
+                        require(1);
+                        append_repeat(run, input_[position++]);
+                    } else {
+                        append_literal(run);
+                    }
+                }
+                continue;
+            }
+
+            if (method == pattern)
+            {
+                const auto period = read_varint();
+                const auto length = read_varint();
+                if (period == 0 || length < period || length > UINT16_MAX) {
+                    throw std::runtime_error("Corrupted repeator block");
+                }
+                room(length);
+
+                // copy the pattern once, then double what has been written until length is reached
+                require(period);
+                const auto offset = output_.size();
+                output_.resize(offset + length);
+                uint8_t * destination = output_.data() + offset;
+                std::memcpy(destination, input_.data() + position, period);
+                position += period;
+                for (uint64_t copied = period; copied < length; )
+                {
+                    const auto chunk = std::min(copied, length - copied);
+                    std::memcpy(destination + copied, destination, chunk);
+                    copied += chunk;
+                }
+                continue;
+            }
+
+            require(2);
+            const uint16_t len = input_[position] | static_cast<uint16_t>(input_[position + 1] << 8);
+            position += 2;
+            room(len);
+
+            if (method == none) {
+                append_literal(len);
             } else if (method == trimmed) {
-                const uint8_t cc = getc();
-                std::vector<uint8_t> tmp(len, cc);
-                output_.insert(end(output_), begin(tmp), end(tmp));
+                require(1);
+                append_repeat(len, input_[position++]);
             }
         }
     }
@@ -0,0 +1,159 @@
+/* train.cpp
+ *
+ * Copyright 2025 Anivice Ives
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include "log.hpp"
+#include "argument_parser.h"
+#include "preset.h"
+
+Arguments::predefined_args_t arguments = {
+    Arguments::single_arg_t {
+        .name = "help",
+        .short_name = 'h',
+        .value_required = false,
+        .explanation = "Show this help message"
+    },
+    Arguments::single_arg_t {
+        .name = "output",
+        .short_name = 'o',
+        .value_required = true,
+        .explanation = "Set output dictionary file"
+    },
+    Arguments::single_arg_t {
+        .name = "input",
+        .short_name = 'i',
+        .value_required = true,
+        .explanation = "Add a sample file, one sample per file"
+    },
+    Arguments::single_arg_t {
+        .name = "version",
+        .short_name = 'v',
+        .value_required = false,
+        .explanation = "Get utility version"
+    },
+    Arguments::single_arg_t {
+        .name = "size",
+        .short_name = 's',
+        .value_required = true,
+        .explanation = "Set maximum dictionary size (in bytes, default 4096)"
+    },
+};
+
+int main(const int argc, const char ** argv)
+{
+    try {
+        const Arguments args(argc, argv, arguments);
+
+        auto print_help = [&]()->void
+            {
+                std::string path = *argv;
+                const auto end = path.find_last_of('/');
+                const auto end_w = path.find_last_of('\\');
+				if (end != std::string::npos) {
+					path = path.substr(end + 1);
+				}
+				else if (end_w != std::string::npos) {
+					path = path.substr(end_w + 1);
+				}
+
+                if (const auto last_dot = path.find_last_of('.');
+                    last_dot != std::string::npos)
+                {
+					path = path.substr(0, last_dot);
+                }
+
+                std::cout << path << " [OPTIONS]" << std::endl;
+                std::cout << "OPTIONS: " << std::endl;
+                args.print_help();
+            };
+
+        if (static_cast<Arguments::args_t>(args).contains("help")) {
+            print_help();
+            return EXIT_SUCCESS;
+        }
+
+        if (static_cast<Arguments::args_t>(args).contains("version")) {
+			std::cout << "Dictionary Training Utility version " << COMPRESS_UTIL_VERSION << std::endl;
+			return EXIT_SUCCESS;
+		}
+
+        uint64_t size = preset::default_size;
+        if (static_cast<Arguments::args_t>(args).contains("size"))
+        {
+            const auto size_literal = static_cast<Arguments::args_t>(args).at("size").back();
+            size = std::strtoull(size_literal.c_str(), nullptr, 10);
+            if (size < preset::segment_size) {
+                throw std::runtime_error("Invalid dictionary size " + size_literal
+                    + ": Size is at least " + std::to_string(preset::segment_size) + " Bytes");
+            }
+        }
+
+        if (static_cast<Arguments::args_t>(args).contains("input"))
+        {
+            if (!static_cast<Arguments::args_t>(args).contains("output"))
+            {
+                throw std::invalid_argument("Output file not provided");
+            }
+
+            const auto output_file = static_cast<Arguments::args_t>(args).at("output");
+            if (output_file.size() != 1) {
+                throw std::invalid_argument("Multiple output files provided");
+            }
+
+            std::vector < std::vector < uint8_t > > samples;
+			const auto input_files = static_cast<Arguments::args_t>(args).at("input");
+            for (const auto & file : input_files)
+            {
+                std::ifstream input_file_stream(file, std::ios::binary);
+                if (!input_file_stream.is_open()) {
+                    throw std::runtime_error("Failed to open input file " + file);
+                }
+
+                samples.emplace_back(std::istreambuf_iterator<char>(input_file_stream), std::istreambuf_iterator<char>());
+            }
+
+            const auto preset_dictionary = preset::train(samples, size);
+            preset::save(output_file[0], preset_dictionary);
+
+            uint64_t dictionary_size = 0;
+            for (const auto & string : preset_dictionary.strings) {
+                dictionary_size += string.size();
+            }
+
+            std::cout << output_file[0] << ": ID " << preset_dictionary.id << ", "
+                      << preset_dictionary.strings.size() << " strings, " << dictionary_size << " bytes" << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+         debug::log(debug::to_stderr, debug::error_log,
+             "No meaningful option provided.\n"
+             "Use `-h` or `--help` to see detailed help information.\n");
+         return EXIT_FAILURE;
+    } catch (const std::invalid_argument& e) {
+        debug::log(debug::to_stderr, debug::error_log, e.what(), "\n\n",
+			"Use `-h` or `--help` to see detailed help information.\n");
+        return EXIT_FAILURE;
+    } catch (const std::exception &e) {
+        debug::log(debug::to_stderr, debug::error_log, e.what(), "\n");
+        return EXIT_FAILURE;
+    }
+}
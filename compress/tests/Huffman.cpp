@@ -22,6 +22,8 @@
 #include "Huffman.h"
 #include "log.hpp"
 #include <cstring>
+#include <random>
+#include <utility>
 
 int main()
 {
@@ -45,5 +47,112 @@ int main()
     huffman2.decompress();
     debug::log(debug::to_stderr, debug::debug_log, "Data after decoding: ", output2, "\n");
 
-    return std::memcmp(backup.data(), output2.data(), std::min(output2.size(), backup.size()));
+    if (output2 != backup) {
+        return EXIT_FAILURE;
+    }
+
+    // skewed symbols give codes of many lengths, decoded a table lookup at a time up to the right-aligned tail
+    std::mt19937 generator(0xED);
+    std::geometric_distribution < int > distribution(0.3);
+    std::vector < uint8_t > skewed;
+    for (int i = 0; i < 16383; i++) {
+        skewed.push_back(static_cast<uint8_t>(distribution(generator)));
+    }
+
+    const auto skewed_backup = skewed;
+    std::vector < uint8_t > skewed_output, skewed_output2;
+    Huffman huffman3(skewed, skewed_output);
+    huffman3.compress();
+
+    Huffman huffman4(skewed_output, skewed_output2);
+    huffman4.decompress();
+
+    if (skewed_output2 != skewed_backup) {
+        debug::log(debug::to_stderr, debug::error_log, "Huffman round trip failed\n");
+        return EXIT_FAILURE;
+    }
+
+    // Fibonacci frequencies make an unbounded tree 20 levels deep, canonical codes are capped at 15 bits
+    std::vector < uint8_t > fibonacci;
+    uint64_t previous = 1, current = 1;
+    for (uint8_t symbol = 0; symbol < 20; symbol++)
+    {
+        fibonacci.insert(fibonacci.end(), current, symbol);
+        current = std::exchange(previous, current) + current;
+    }
+
+    const auto fibonacci_backup = fibonacci;
+    std::vector < uint8_t > canonical_output, canonical_output2;
+    Huffman huffman5(fibonacci, canonical_output);
+    huffman5.compress_canonical();
+
+    Huffman huffman6(canonical_output, canonical_output2);
+    huffman6.decompress_canonical();
+
+    if (canonical_output2 != fibonacci_backup) {
+        debug::log(debug::to_stderr, debug::error_log, "Canonical Huffman round trip failed\n");
+        return EXIT_FAILURE;
+    }
+
+    // the skewed block comes out no larger than with the approximate tree
+    skewed = skewed_backup;
+    canonical_output.clear();
+    canonical_output2.clear();
+    Huffman huffman7(skewed, canonical_output);
+    huffman7.compress_canonical();
+
+    Huffman huffman8(canonical_output, canonical_output2);
+    huffman8.decompress_canonical();
+
+    if (canonical_output2 != skewed_backup || canonical_output.size() > skewed_output.size()) {
+        debug::log(debug::to_stderr, debug::error_log, "Canonical Huffman round trip failed\n");
+        return EXIT_FAILURE;
+    }
+
+    // four interleaved streams, including inputs too short to fill all of them
+    for (const uint64_t size : { 1, 2, 3, 5, 16383 })
+    {
+        std::vector < uint8_t > interleaved(skewed_backup.begin(), skewed_backup.begin() + static_cast<std::ptrdiff_t>(size));
+        const auto interleaved_backup = interleaved;
+        std::vector < uint8_t > interleaved_output, interleaved_output2;
+        Huffman huffman9(interleaved, interleaved_output);
+        huffman9.compress_interleaved();
+
+        Huffman huffman10(interleaved_output, interleaved_output2);
+        huffman10.decompress_interleaved();
+
+        if (interleaved_output2 != interleaved_backup) {
+            debug::log(debug::to_stderr, debug::error_log, "Interleaved Huffman round trip failed\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    // a second block drawn from the same distribution reuses the table of the first one and leaves it out
+    huffman_solid_table encoder_table, decoder_table;
+    for (int block = 0; block < 2; block++)
+    {
+        std::vector < uint8_t > solid;
+        for (int i = 0; i < 16383; i++) {
+            solid.push_back(static_cast<uint8_t>(std::min(distribution(generator), 7)));
+        }
+
+        const auto solid_backup = solid;
+        std::vector < uint8_t > solid_output, solid_output2;
+        Huffman huffman11(solid, solid_output, encoder_table);
+        const bool repeated = huffman11.compress_solid(true);
+
+        Huffman huffman12(solid_output, solid_output2, decoder_table);
+        if (repeated) {
+            huffman12.decompress_repeat(true);
+        } else {
+            huffman12.decompress_interleaved();
+        }
+
+        if (solid_output2 != solid_backup || repeated != (block == 1)) {
+            debug::log(debug::to_stderr, debug::error_log, "Solid Huffman round trip failed\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
 }
@@ -19,8 +19,10 @@
  */
 
 #include "arithmetic.h"
+#include "context.h"
 #include <vector>
 #include <cstdint>
+#include <stdexcept>
 
 int main()
 {
@@ -45,4 +47,71 @@ int main()
 
     arithmetic::Decode decompressor(input2, output2);
     decompressor.decode();
+
+    // range coder on the same model
+    for (const auto & sample : { data, data2 })
+    {
+        std::vector < uint8_t > range_input = sample, range_output, range_output2;
+        arithmetic::RangeEncode range_compressor(range_input, range_output);
+        range_compressor.encode();
+
+        arithmetic::RangeDecode range_decompressor(range_output, range_output2);
+        range_decompressor.decode();
+        if (range_output2 != sample) {
+            throw std::runtime_error("Range coder round trip failed");
+        }
+
+        // cut short, the decoder runs out of input before EOF
+        range_output.resize(range_output.size() / 2);
+        range_output2.clear();
+        arithmetic::RangeDecode truncated_decompressor(range_output, range_output2);
+        try {
+            truncated_decompressor.decode();
+            throw std::logic_error("Truncated range coded stream was accepted");
+        } catch (const std::runtime_error &) {
+        }
+
+        std::vector < uint8_t > static_input = sample, static_output, static_output2;
+        arithmetic::StaticEncode static_compressor(static_input, static_output);
+        static_compressor.encode();
+
+        arithmetic::StaticDecode static_decompressor(static_output, static_output2);
+        static_decompressor.decode();
+        if (static_output2 != sample) {
+            throw std::runtime_error("Semi-static round trip failed");
+        }
+
+        std::vector < uint8_t > binary_input = sample, binary_output, binary_output2;
+        arithmetic::BinaryEncode binary_compressor(binary_input, binary_output);
+        binary_compressor.encode();
+
+        arithmetic::BinaryDecode binary_decompressor(binary_output, binary_output2);
+        binary_decompressor.decode();
+        if (binary_output2 != sample) {
+            throw std::runtime_error("Binary coder round trip failed");
+        }
+
+        for (const int order : { 1, 2 })
+        {
+            std::vector < uint8_t > context_input = sample, context_output, context_output2;
+            arithmetic::ContextEncode context_compressor(context_input, context_output, order);
+            context_compressor.encode();
+
+            arithmetic::ContextDecode context_decompressor(context_output, context_output2, order);
+            context_decompressor.decode();
+            if (context_output2 != sample) {
+                throw std::runtime_error("Context model round trip failed");
+            }
+
+            // cut short, the decoder has to stop on its own rather than run on
+            context_output.resize(context_output.size() / 2);
+            context_output2.clear();
+            arithmetic::ContextDecode truncated_decompressor(context_output, context_output2, order);
+            try {
+                truncated_decompressor.decode();
+                throw std::logic_error("Truncated context model stream was accepted");
+            } catch (const std::runtime_error &) {
+            }
+        }
+    }
 }
@@ -0,0 +1,75 @@
+/* lz77.cpp
+ *
+ * Copyright 2025 Anivice Ives
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "lz77.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+int main()
+{
+    // shorter than a match, one byte over and over (overlapping copies), short periods,
+    // long literal and match lengths, and text
+    std::vector < std::vector < uint8_t > > samples;
+    samples.push_back({ 'a', 'b', 'c' });
+    samples.emplace_back(16384, 'a');
+    for (int period = 2; period < 12; period++)
+    {
+        samples.emplace_back();
+        for (int i = 0; i < 1000; i++) {
+            samples.back().push_back(static_cast<uint8_t>(i % period + 'a'));
+        }
+    }
+    samples.emplace_back();
+    for (int i = 0; i < 4000; i++) {
+        samples.back().push_back(static_cast<uint8_t>(i * 37 % 256));
+    }
+    samples.back().insert(samples.back().end(), samples.back().begin(), samples.back().end());
+    samples.emplace_back();
+    for (int i = 0; i < 500; i++) {
+        const std::string line = "entry " + std::to_string(i * i % 97) + " took " + std::to_string(i % 13) + "ms\n";
+        samples.back().insert(samples.back().end(), line.begin(), line.end());
+    }
+
+    for (const auto & sample : samples)
+    {
+        std::vector < uint8_t > input = sample, output, output2;
+        lz77::lz77 compressor(input, output);
+        compressor.encode();
+
+        lz77::lz77 decompressor(output, output2);
+        decompressor.decode();
+        if (output2 != sample) {
+            throw std::runtime_error("LZ77 round trip failed");
+        }
+    }
+
+    // an offset reaching back before the start of the block
+    std::vector < uint8_t > corrupted = { 4, 0, 0x10, 'a', 2, 0 }, output;
+    lz77::lz77 decompressor(corrupted, output);
+    try {
+        decompressor.decode();
+    } catch (const std::runtime_error &) {
+        return 0;
+    }
+
+    throw std::runtime_error("Corrupted LZ77 block was accepted");
+}
@@ -0,0 +1,168 @@
+/* lzw.cpp
+ *
+ * Copyright 2025 Anivice Ives
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "lzw.h"
+#include "log.hpp"
+#include <random>
+
+int main()
+{
+    debug::set_log_level(debug::L_DEBUG_FG);
+
+    // a run of one symbol exercises the code-not-yet-in-table case (KwKwK)
+    std::vector < uint8_t > data(4096, 'a');
+    std::mt19937 generator(0x1f9d);
+    for (int i = 0; i < 16384; i++) {
+        data.push_back("ABCDEFGH"[generator() % 8]);
+    }
+
+    const auto backup = data;
+    std::vector < uint8_t > compressed, decompressed;
+    lzw <9> compressor(data, compressed);
+    compressor.compress();
+
+    lzw <9> decompressor(compressed, decompressed);
+    decompressor.decompress();
+
+    if (decompressed != backup) {
+        debug::log(debug::to_stderr, debug::error_log, "LZW round trip failed\n");
+        return EXIT_FAILURE;
+    }
+
+    // 12-bit codes fill up on this data, so the dictionary is reset at least once
+    data = backup;
+    compressed.clear();
+    decompressed.clear();
+    lzw <12> variable_compressor(data, compressed);
+    variable_compressor.compress_variable();
+
+    lzw <12> variable_decompressor(compressed, decompressed);
+    variable_decompressor.decompress_variable();
+
+    if (decompressed != backup) {
+        debug::log(debug::to_stderr, debug::error_log, "Variable width LZW round trip failed\n");
+        return EXIT_FAILURE;
+    }
+
+    // a 9-bit dictionary filled by the first half is useless for the second one, the adaptive encoder resets it
+    std::vector < uint8_t > shifting = backup;
+    for (int i = 0; i < 16384; i++) {
+        shifting.push_back("stuvwxyz"[generator() % 8]);
+    }
+
+    data = shifting;
+    compressed.clear();
+    decompressed.clear();
+    lzw <9> adaptive_compressor(data, compressed);
+    adaptive_compressor.compress_adaptive();
+
+    lzw <9> adaptive_decompressor(compressed, decompressed);
+    adaptive_decompressor.decompress_adaptive();
+
+    data = shifting;
+    std::vector < uint8_t > frozen;
+    lzw <9> frozen_compressor(data, frozen);
+    frozen_compressor.compress();
+
+    if (decompressed != shifting || compressed.size() >= frozen.size()) {
+        debug::log(debug::to_stderr, debug::error_log, "Adaptive LZW round trip failed\n");
+        return EXIT_FAILURE;
+    }
+
+    // solid blocks continue with the dictionary left by the previous one, and the second block compresses better
+    lzw_solid_dictionary encoder_dictionary, decoder_dictionary;
+    std::vector < uint64_t > solid_sizes;
+    for (int block = 0; block < 2; block++)
+    {
+        data = backup;
+        compressed.clear();
+        decompressed.clear();
+        lzw <16> solid_compressor(data, compressed, encoder_dictionary);
+        solid_compressor.compress_variable();
+        solid_sizes.push_back(compressed.size());
+
+        lzw <16> solid_decompressor(compressed, decompressed, decoder_dictionary);
+        solid_decompressor.decompress_variable();
+
+        if (decompressed != backup) {
+            debug::log(debug::to_stderr, debug::error_log, "Solid LZW round trip failed\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (solid_sizes[1] >= solid_sizes[0]) {
+        debug::log(debug::to_stderr, debug::error_log, "Solid LZW did not reuse its dictionary\n");
+        return EXIT_FAILURE;
+    }
+
+    // a small input starting from a dictionary primed with strings it shares comes out smaller than without
+    const std::string request = "GET /index.html HTTP/1.1\r\nHost: example.com\r\nAccept: text/html\r\n\r\n";
+    const std::vector < std::vector < uint8_t > > preset_strings = { { request.begin(), request.end() } };
+    lzw_solid_dictionary primed_encoder_dictionary, primed_decoder_dictionary;
+    std::vector < uint8_t > unused, primed;
+    lzw <12> (unused, unused, primed_encoder_dictionary).prime(preset_strings);
+    lzw <12> (unused, unused, primed_decoder_dictionary).prime(preset_strings);
+
+    data.assign(request.begin(), request.end());
+    lzw <12> primed_compressor(data, primed, primed_encoder_dictionary);
+    primed_compressor.compress_variable();
+
+    data.assign(request.begin(), request.end());
+    compressed.clear();
+    decompressed.clear();
+    lzw <12> unprimed_compressor(data, compressed);
+    unprimed_compressor.compress_variable();
+
+    lzw <12> primed_decompressor(primed, decompressed, primed_decoder_dictionary);
+    primed_decompressor.decompress_variable();
+
+    if (decompressed != std::vector < uint8_t > (request.begin(), request.end()) || primed.size() >= compressed.size()) {
+        debug::log(debug::to_stderr, debug::error_log, "Primed LZW round trip failed\n");
+        return EXIT_FAILURE;
+    }
+
+    // a compress(1) stream is cut into chunks that split codes and groups of codes at arbitrary points
+    lzw_solid_dictionary unix_encoder_dictionary, unix_decoder_dictionary;
+    std::vector < uint8_t > unix_stream, unix_decompressed;
+    for (uint64_t offset = 0; offset < backup.size(); offset += 1000)
+    {
+        std::vector < uint8_t > chunk(backup.begin() + static_cast<std::ptrdiff_t>(offset),
+            backup.begin() + static_cast<std::ptrdiff_t>(std::min<uint64_t>(offset + 1000, backup.size())));
+        lzw <16> unix_compressor(chunk, unix_stream, unix_encoder_dictionary);
+        unix_compressor.compress_unix(offset + 1000 >= backup.size());
+    }
+
+    std::vector < uint8_t > unix_chunk;
+    for (uint64_t offset = 0; offset < unix_stream.size(); offset += 333)
+    {
+        unix_chunk.insert(end(unix_chunk), unix_stream.begin() + static_cast<std::ptrdiff_t>(offset),
+            unix_stream.begin() + static_cast<std::ptrdiff_t>(std::min<uint64_t>(offset + 333, unix_stream.size())));
+        lzw <16> unix_decompressor(unix_chunk, unix_decompressed, unix_decoder_dictionary);
+        unix_decompressor.decompress_unix(offset + 333 >= unix_stream.size());
+    }
+
+    if (unix_decompressed != backup) {
+        debug::log(debug::to_stderr, debug::error_log, "compress(1) stream round trip failed\n");
+        return EXIT_FAILURE;
+    }
+
+    debug::log(debug::to_stderr, debug::debug_log, "LZW round trip passed\n");
+    return EXIT_SUCCESS;
+}
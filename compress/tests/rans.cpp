@@ -0,0 +1,52 @@
+/* rans.cpp
+ *
+ * Copyright 2025 Anivice Ives
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "rans.h"
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+int main()
+{
+    // a single symbol, a skewed spread that needs two byte frequencies, and all 256 symbols
+    std::vector < std::vector < uint8_t > > samples;
+    samples.emplace_back(1024, 'a');
+    samples.emplace_back();
+    for (int i = 0; i < 16384; i++) {
+        samples.back().push_back(i % 7 == 0 ? static_cast<uint8_t>(i % 251) : 'e');
+    }
+    samples.emplace_back();
+    for (int i = 0; i < 3000; i++) {
+        samples.back().push_back(static_cast<uint8_t>(i * 37 % 256));
+    }
+
+    for (const auto & sample : samples)
+    {
+        std::vector < uint8_t > input = sample, output, output2;
+        rans::rans compressor(input, output);
+        compressor.encode();
+
+        rans::rans decompressor(output, output2);
+        decompressor.decode();
+        if (output2 != sample) {
+            throw std::runtime_error("rANS round trip failed");
+        }
+    }
+}
@@ -19,6 +19,7 @@
  */
 
 #include "repeator.h"
+#include <stdexcept>
 
 int main()
 {
@@ -29,4 +30,80 @@ int main()
     compressor.encode();
     repeator::repeator decompressor(out, out2);
     decompressor.decode();
+
+    // zero and 0xFF stretches within mixed data, runs at both ends and runs just below the minimum
+    std::vector<uint8_t> data3(300, 0);
+    for (int i = 0; i < 1000; i++) {
+        data3.push_back(static_cast<uint8_t>(i * 7 % 13));
+    }
+    data3.insert(data3.end(), 5000, 0xFF);
+    data3.insert(data3.end(), { 1, 1, 1, 2, 3, 3, 3, 3, 4 });
+    data3.insert(data3.end(), 200, 0);
+
+    // a short record repeated, a period of 64 cut short, and one broken by a byte in the middle
+    std::vector<uint8_t> data4;
+    for (int i = 0; i < 500; i++) {
+        data4.insert(data4.end(), { 0x10, 0x20, 0x30, 0x40, 0x50 });
+    }
+    for (int i = 0; i < 64 * 20 + 17; i++) {
+        data4.push_back(static_cast<uint8_t>(i % 64 * 3));
+    }
+    for (int i = 0; i < 300; i++) {
+        data4.push_back(i == 150 ? 0xEE : static_cast<uint8_t>(i % 3 + 1));
+    }
+
+    for (const auto & sample : { data, data2, data3, data4 })
+    {
+        std::vector<uint8_t> input = sample, encoded, decoded;
+        repeator::repeator run_compressor(input, encoded);
+        run_compressor.encode();
+        repeator::repeator run_decompressor(encoded, decoded);
+        run_decompressor.decode();
+        if (decoded != sample) {
+            throw std::runtime_error("Repeator round trip failed");
+        }
+    }
+
+    if (out.size() >= data2.size() + 3 + 3) {
+        throw std::runtime_error("Repeator expanded a block");
+    }
+
+    std::vector<uint8_t> periodic_input = data4, periodic_output;
+    repeator::repeator periodic_compressor(periodic_input, periodic_output);
+    periodic_compressor.encode();
+    if (periodic_output.size() > 200) {
+        throw std::runtime_error("Repeator missed a periodic pattern");
+    }
+
+    // records written before runs existed
+    std::vector<uint8_t> legacy = { repeator::trimmed, 0x00, 0x04, 0x5A, repeator::none, 0x02, 0x00, 'o', 'k' }, legacy_out;
+    repeator::repeator legacy_decompressor(legacy, legacy_out);
+    legacy_decompressor.decode();
+    if (legacy_out.size() != 1026 || legacy_out[1023] != 0x5A || legacy_out[1024] != 'o' || legacy_out[1025] != 'k') {
+        throw std::runtime_error("Repeator legacy records failed");
+    }
+
+    // empty records into an empty output
+    std::vector<uint8_t> empty = { repeator::none, 0x00, 0x00, repeator::trimmed, 0x00, 0x00, 0x5A }, empty_out;
+    repeator::repeator empty_decompressor(empty, empty_out);
+    empty_decompressor.decode();
+    if (!empty_out.empty()) {
+        throw std::runtime_error("Repeator empty records failed");
+    }
+
+    // a runs record asking for 2^31 bytes, and trimmed records adding up to more than a block
+    std::vector < std::vector < uint8_t > > oversized = {
+        { repeator::runs, 0x80, 0x80, 0x80, 0x80, 0x08, 0xF9, 0xFF, 0xFF, 0xFF, 0x0F, 0xAA },
+        { repeator::trimmed, 0xFF, 0xFF, 0x00, repeator::trimmed, 0xFF, 0xFF, 0x00 },
+    };
+    for (auto & corrupted : oversized)
+    {
+        std::vector<uint8_t> corrupted_out;
+        repeator::repeator corrupted_decompressor(corrupted, corrupted_out);
+        try {
+            corrupted_decompressor.decode();
+            throw std::logic_error("Oversized repeator block was accepted");
+        } catch (const std::runtime_error &) {
+        }
+    }
 }